@@ -272,6 +272,36 @@ namespace fs
 		return this->write(buf.get(), total);
 	}
 
+	u64 file_base::read_at(u64 offset, void* buffer, u64 size)
+	{
+		// Generic fallback, not thread-safe
+		const u64 old_pos = seek(0, seek_cur);
+
+		if (seek(offset, seek_set) != offset)
+		{
+			return 0;
+		}
+
+		const u64 result = read(buffer, size);
+		seek(old_pos, seek_set);
+		return result;
+	}
+
+	u64 file_base::write_at(u64 offset, const void* buffer, u64 size)
+	{
+		// Generic fallback, not thread-safe
+		const u64 old_pos = seek(0, seek_cur);
+
+		if (seek(offset, seek_set) != offset)
+		{
+			return 0;
+		}
+
+		const u64 result = write(buffer, size);
+		seek(old_pos, seek_set);
+		return result;
+	}
+
 	dir_base::~dir_base()
 	{
 	}
@@ -1104,6 +1134,23 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 	{
 		const HANDLE m_handle;
 
+		// The OVERLAPPED offset of positional operations still moves the file pointer (the handle is synchronous)
+		shared_mutex m_pos_mutex;
+
+		u64 get_pos()
+		{
+			LARGE_INTEGER pos{};
+			ensure(SetFilePointerEx(m_handle, pos, &pos, FILE_CURRENT)); // "file::pos"
+			return pos.QuadPart;
+		}
+
+		void set_pos(u64 offset)
+		{
+			LARGE_INTEGER pos;
+			pos.QuadPart = offset;
+			ensure(SetFilePointerEx(m_handle, pos, nullptr, FILE_BEGIN)); // "file::pos"
+		}
+
 	public:
 		windows_file(HANDLE handle)
 			: m_handle(handle)
@@ -1155,6 +1202,8 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 
 		u64 read(void* buffer, u64 count) override
 		{
+			std::lock_guard lock(m_pos_mutex);
+
 			u64 nread_sum = 0;
 
 			for (char* data = static_cast<char*>(buffer); count;)
@@ -1179,6 +1228,8 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 
 		u64 write(const void* buffer, u64 count) override
 		{
+			std::lock_guard lock(m_pos_mutex);
+
 			u64 nwritten_sum = 0;
 
 			for (const char* data = static_cast<const char*>(buffer); count;)
@@ -1215,6 +1266,8 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 				whence == seek_set ? FILE_BEGIN :
 				whence == seek_cur ? FILE_CURRENT : FILE_END;
 
+			std::lock_guard lock(m_pos_mutex);
+
 			if (!SetFilePointerEx(m_handle, pos, &pos, mode))
 			{
 				g_tls_error = to_error(GetLastError());
@@ -1236,6 +1289,80 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 		{
 			return m_handle;
 		}
+
+		u64 read_at(u64 offset, void* buffer, u64 count) override
+		{
+			std::lock_guard lock(m_pos_mutex);
+
+			const u64 old_pos = get_pos();
+
+			u64 nread_sum = 0;
+
+			for (char* data = static_cast<char*>(buffer); count;)
+			{
+				const DWORD size = static_cast<DWORD>(std::min<u64>(count, DWORD{umax} & -4096));
+
+				// The offset is passed through OVERLAPPED, the read is still synchronous
+				OVERLAPPED ovl{};
+				ovl.Offset = static_cast<DWORD>(offset);
+				ovl.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+				DWORD nread = 0;
+
+				if (!ReadFile(m_handle, data, size, &nread, &ovl))
+				{
+					ensure(GetLastError() == ERROR_HANDLE_EOF); // "file::read_at"
+				}
+
+				nread_sum += nread;
+
+				if (nread < size)
+				{
+					break;
+				}
+
+				count -= size;
+				data += size;
+				offset += size;
+			}
+
+			set_pos(old_pos);
+			return nread_sum;
+		}
+
+		u64 write_at(u64 offset, const void* buffer, u64 count) override
+		{
+			std::lock_guard lock(m_pos_mutex);
+
+			const u64 old_pos = get_pos();
+
+			u64 nwritten_sum = 0;
+
+			for (const char* data = static_cast<const char*>(buffer); count;)
+			{
+				const DWORD size = static_cast<DWORD>(std::min<u64>(count, DWORD{umax} & -4096));
+
+				OVERLAPPED ovl{};
+				ovl.Offset = static_cast<DWORD>(offset);
+				ovl.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+				DWORD nwritten = 0;
+				ensure(WriteFile(m_handle, data, size, &nwritten, &ovl)); // "file::write_at"
+				nwritten_sum += nwritten;
+
+				if (nwritten < size)
+				{
+					break;
+				}
+
+				count -= size;
+				data += size;
+				offset += size;
+			}
+
+			set_pos(old_pos);
+			return nwritten_sum;
+		}
 	};
 
 	m_file = std::make_unique<windows_file>(handle);
@@ -1410,6 +1537,48 @@ fs::file::file(const std::string& path, bs_t<open_mode> mode)
 
 			return result;
 		}
+
+		u64 read_at(u64 offset, void* buffer, u64 count) override
+		{
+			u64 result = 0;
+
+			while (count)
+			{
+				const auto nread = ::pread(m_fd, static_cast<char*>(buffer) + result, count, offset + result);
+				ensure(nread != -1); // "file::read_at"
+
+				if (nread == 0)
+				{
+					break;
+				}
+
+				result += nread;
+				count -= nread;
+			}
+
+			return result;
+		}
+
+		u64 write_at(u64 offset, const void* buffer, u64 count) override
+		{
+			u64 result = 0;
+
+			while (count)
+			{
+				const auto nwritten = ::pwrite(m_fd, static_cast<const char*>(buffer) + result, count, offset + result);
+				ensure(nwritten != -1); // "file::write_at"
+
+				if (nwritten == 0)
+				{
+					break;
+				}
+
+				result += nwritten;
+				count -= nwritten;
+			}
+
+			return result;
+		}
 	};
 
 	m_file = std::make_unique<unix_file>(fd);
@@ -98,6 +98,8 @@ namespace fs
 		virtual u64 size() = 0;
 		virtual native_handle get_handle();
 		virtual u64 write_gather(const iovec_clone* buffers, u64 buf_count);
+		virtual u64 read_at(u64 offset, void* buffer, u64 size);
+		virtual u64 write_at(u64 offset, const void* buffer, u64 size);
 	};
 
 	// Directory entry (TODO)
@@ -497,6 +499,28 @@ namespace fs
 			if (!m_file) xnull({line, col, file, func});
 			return m_file->write_gather(buffers, buf_count);
 		}
+
+		// Read the data at the specified position, the current position is preserved (thread-safe for native files)
+		u64 read_at(u64 offset, void* buffer, u64 count,
+			u32 line = __builtin_LINE(),
+			u32 col = __builtin_COLUMN(),
+			const char* file = __builtin_FILE(),
+			const char* func = __builtin_FUNCTION()) const
+		{
+			if (!m_file) xnull({line, col, file, func});
+			return m_file->read_at(offset, buffer, count);
+		}
+
+		// Write the data at the specified position, the current position is preserved (thread-safe for native files)
+		u64 write_at(u64 offset, const void* buffer, u64 count,
+			u32 line = __builtin_LINE(),
+			u32 col = __builtin_COLUMN(),
+			const char* file = __builtin_FILE(),
+			const char* func = __builtin_FUNCTION()) const
+		{
+			if (!m_file) xnull({line, col, file, func});
+			return m_file->write_at(offset, buffer, count);
+		}
 	};
 
 	class dir final
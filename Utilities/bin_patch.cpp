@@ -8,6 +8,7 @@
 #include "util/types.hpp"
 #include "util/endian.hpp"
 #include "util/asm.hpp"
+#include "util/serialization.hpp"
 
 #include <charconv>
 
@@ -568,6 +569,234 @@ void patch_engine::append_title_patches(const std::string& title_id)
 	load(m_map, get_patches_path() + title_id + "_patch.yml");
 }
 
+// Compiled patch index format version (bump on any change of the serialized layout)
+static constexpr u32 patch_index_version = 1;
+
+static void serialize_patch_info(utils::serial& ar, patch_engine::patch_info& info)
+{
+	ar(info.description, info.patch_version, info.patch_group, info.author, info.notes, info.source_path, info.hash, info.version);
+
+	usz count = info.data_list.size();
+	ar(count);
+
+	if (!ar.is_writing())
+	{
+		info.data_list.resize(count);
+	}
+
+	for (auto& data : info.data_list)
+	{
+		ar(data.type, data.offset, data.original_value, data.value.long_value);
+	}
+
+	count = info.titles.size();
+	ar(count);
+
+	if (ar.is_writing())
+	{
+		for (auto& [title, serials] : info.titles)
+		{
+			ar(title, serials.size());
+
+			for (auto& [serial, app_versions] : serials)
+			{
+				ar(serial, app_versions.size());
+
+				for (auto& [app_version, enabled] : app_versions)
+				{
+					ar(app_version, enabled);
+				}
+			}
+		}
+
+		return;
+	}
+
+	for (usz i = 0; i < count; i++)
+	{
+		auto& serials = info.titles[ar.operator std::string()];
+
+		for (usz j = 0, serial_count = ar; j < serial_count; j++)
+		{
+			auto& app_versions = serials[ar.operator std::string()];
+
+			for (usz k = 0, version_count = ar; k < version_count; k++)
+			{
+				std::string app_version = ar;
+				app_versions.emplace(std::move(app_version), ar.operator bool());
+			}
+		}
+	}
+}
+
+static std::string get_patch_index_path(const std::string& title_id)
+{
+	return fs::get_cache_dir() + "patches/" + (title_id.empty() ? "none" : title_id) + ".bin";
+}
+
+// Describes the state of every file the index depends on
+static std::string get_patch_index_signature(const std::vector<std::string>& sources)
+{
+	std::string signature = fmt::format("%u-%s", patch_index_version, patch_engine_version);
+
+	for (const std::string& path : sources)
+	{
+		fs::stat_t stat{};
+
+		if (fs::stat(path, stat))
+		{
+			fmt::append(signature, "\n%s:%u:%d", path, stat.size, stat.mtime);
+		}
+		else
+		{
+			fmt::append(signature, "\n%s:-", path);
+		}
+	}
+
+	return signature;
+}
+
+static bool load_patch_index(patch_engine::patch_map& patches, const std::string& path, const std::string& signature)
+{
+	fs::file file(path);
+
+	if (!file || file.size() < sizeof(u64))
+	{
+		return false;
+	}
+
+	std::vector<u8> data = file.to_vector<u8>();
+
+	// Trailing hash of the contents, protects against truncated or damaged files
+	u64 hash = 0;
+	std::memcpy(&hash, data.data() + data.size() - sizeof(u64), sizeof(u64));
+	data.resize(data.size() - sizeof(u64));
+
+	if (hash != std::hash<std::string_view>()({reinterpret_cast<const char*>(data.data()), data.size()}))
+	{
+		patch_log.warning("Patch index %s is damaged", path);
+		return false;
+	}
+
+	utils::serial ar;
+	ar.set_reading_state(std::move(data));
+
+	if (ar.operator std::string() != signature)
+	{
+		// Outdated
+		return false;
+	}
+
+	for (usz i = 0, count = ar; i < count; i++)
+	{
+		const std::string key = ar;
+		auto& container = patches[key];
+		ar(container.hash, container.version);
+
+		for (usz j = 0, patch_count = ar; j < patch_count; j++)
+		{
+			patch_engine::patch_info info{};
+			serialize_patch_info(ar, info);
+			container.patch_info_map.insert_or_assign(info.description, std::move(info));
+		}
+	}
+
+	return true;
+}
+
+static void save_patch_index(patch_engine::patch_map& patches, const std::string& path, const std::string& signature)
+{
+	utils::serial ar;
+	ar(signature, patches.size());
+
+	for (auto& [key, container] : patches)
+	{
+		ar(key, container.hash, container.version, container.patch_info_map.size());
+
+		for (auto& [description, info] : container.patch_info_map)
+		{
+			serialize_patch_info(ar, info);
+		}
+	}
+
+	const u64 hash = std::hash<std::string_view>()({reinterpret_cast<const char*>(ar.data.data()), ar.data.size()});
+	ar(hash);
+
+	if (!fs::create_path(fs::get_parent_dir(path)))
+	{
+		patch_log.error("Failed to create directory for %s (%s)", path, fs::g_tls_error);
+		return;
+	}
+
+	fs::pending_file file(path);
+
+	if (!file.file || !file.file.write(ar.data.data(), ar.data.size()) || !file.commit())
+	{
+		patch_log.error("Failed to write patch index %s (%s)", path, fs::g_tls_error);
+	}
+}
+
+void patch_engine::append_boot_patches(const std::string& title_id)
+{
+	std::vector<std::string> sources{get_patches_path() + "patch.yml", get_imported_patch_path()};
+
+	if (!title_id.empty())
+	{
+		sources.emplace_back(get_patches_path() + title_id + "_patch.yml");
+	}
+
+	// Enabled states are resolved while loading
+	sources.emplace_back(get_patch_config_path());
+
+	const std::string index_path = get_patch_index_path(title_id);
+	const std::string signature = get_patch_index_signature(sources);
+
+	patch_map patches;
+
+	if (load_patch_index(patches, index_path, signature))
+	{
+		patch_log.notice("Loaded %u patch containers from %s", patches.size(), index_path);
+		m_map.merge(patches);
+		return;
+	}
+
+	// Same order as append_global_patches() + append_title_patches()
+	for (usz i = 0; i + 1 < sources.size(); i++)
+	{
+		load(patches, sources[i]);
+	}
+
+	// Only keep what apply() can select for this title: entries for its serial or for all serials
+	for (auto it = patches.begin(); it != patches.end();)
+	{
+		auto& infos = it->second.patch_info_map;
+
+		for (auto info = infos.begin(); info != infos.end();)
+		{
+			auto& titles = info->second.titles;
+
+			for (auto title = titles.begin(); title != titles.end();)
+			{
+				std::erase_if(title->second, [&](const auto& serial)
+				{
+					return serial.first != title_id && serial.first != patch_key::all;
+				});
+
+				title = title->second.empty() ? titles.erase(title) : std::next(title);
+			}
+
+			info = titles.empty() ? infos.erase(info) : std::next(info);
+		}
+
+		it = infos.empty() ? patches.erase(it) : std::next(it);
+	}
+
+	save_patch_index(patches, index_path, signature);
+
+	patch_log.notice("Compiled %u patch containers to %s", patches.size(), index_path);
+	m_map.merge(patches);
+}
+
 void ppu_register_range(u32 addr, u32 size);
 bool ppu_form_branch_to_code(u32 entry, u32 target, bool link = false, bool with_toc = false, std::string module_name = {});
 u32 ppu_generate_id(std::string_view name);
@@ -153,6 +153,10 @@ public:
 	// Load from title relevant files and append to member patches map
 	void append_title_patches(const std::string& title_id);
 
+	// Append the patches which may apply to the title (all patch files, filtered by serial) to member patches map
+	// Uses a compiled index in the cache directory which is only rebuilt when one of the patch files changes
+	void append_boot_patches(const std::string& title_id);
+
 	// Apply patch (returns the number of entries applied)
 	std::basic_string<u32> apply(const std::string& name, u8* dst, u32 filesz = -1, u32 min_addr = 0);
 
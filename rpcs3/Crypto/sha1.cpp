@@ -29,8 +29,16 @@
  */
 
 #include "sha1.h"
+#include "sha_simd.h"
 #include "utils.h"
 
+#include "util/sysinfo.hpp"
+
+#if defined(ARCH_X64)
+static const bool s_use_sha_ni = utils::has_sha();
+static const bool s_use_avx2 = utils::has_avx2();
+#endif
+
 /*
  * 32-bit integer manipulation macros (big endian)
  */
@@ -71,6 +79,14 @@ void sha1_starts( sha1_context *ctx )
 
 void sha1_process( sha1_context *ctx, const unsigned char data[64] )
 {
+#if defined(ARCH_X64)
+    if( s_use_sha_ni )
+    {
+        sha1_ni_process_blocks( ctx->state, data, 1 );
+        return;
+    }
+#endif
+
     uint32_t temp, W[16], A, B, C, D, E;
 
     GET_UINT32_BE( W[ 0], data,  0 );
@@ -255,6 +271,15 @@ void sha1_update( sha1_context *ctx, const unsigned char *input, size_t ilen )
         left = 0;
     }
 
+#if defined(ARCH_X64)
+    if( s_use_sha_ni && ilen >= 64 )
+    {
+        sha1_ni_process_blocks( ctx->state, input, ilen / 64 );
+        input += ilen & ~size_t{63};
+        ilen  &= 63;
+    }
+#endif
+
     while( ilen >= 64 )
     {
         sha1_process( ctx, input );
@@ -317,6 +342,112 @@ void sha1( const unsigned char *input, size_t ilen, unsigned char output[20] )
     mbedtls_zeroize( &ctx, sizeof( sha1_context ) );
 }
 
+#if defined(ARCH_X64)
+/*
+ * Multi-buffer SHA-1: each of the 8 lanes hashes one buffer, and takes the next one when done
+ */
+typedef struct
+{
+    size_t index;               /*!< buffer being hashed        */
+    size_t block;               /*!< next block                 */
+    size_t full;                /*!< blocks read from the input */
+    size_t blocks;              /*!< total number of blocks     */
+    unsigned char tail[128];    /*!< last bytes with padding    */
+}
+sha1_lane;
+
+static bool sha1_lane_start( sha1_lane *lane, uint32_t state[5][8], int l,
+                             const unsigned char *const input[], const size_t ilen[], size_t index )
+{
+    const size_t rem = ilen[index] & 63;
+    const uint64_t bits = static_cast<uint64_t>(ilen[index]) * 8;
+
+    lane->index = index;
+    lane->block = 0;
+    lane->full = ilen[index] / 64;
+    lane->blocks = lane->full + ( rem < 56 ? 1 : 2 );
+
+    memset( lane->tail, 0, sizeof( lane->tail ) );
+
+    if( rem )
+        memcpy( lane->tail, input[index] + lane->full * 64, rem );
+
+    lane->tail[rem] = 0x80;
+
+    unsigned char *end = lane->tail + ( lane->blocks - lane->full ) * 64;
+    PUT_UINT32_BE( static_cast<uint32_t>( bits >> 32 ), end, -8 );
+    PUT_UINT32_BE( static_cast<uint32_t>( bits ), end, -4 );
+
+    state[0][l] = 0x67452301;
+    state[1][l] = 0xEFCDAB89;
+    state[2][l] = 0x98BADCFE;
+    state[3][l] = 0x10325476;
+    state[4][l] = 0xC3D2E1F0;
+    return true;
+}
+
+static void sha1_multi_avx2( const unsigned char *const input[], const size_t ilen[],
+                             unsigned char output[][20], size_t count )
+{
+    static const unsigned char idle[64] = {};
+
+    sha1_lane lanes[8];
+    bool busy[8];
+    uint32_t state[5][8];
+    const unsigned char *data[8];
+    size_t next = 0;
+
+    for( int l = 0; l < 8; l++ )
+        busy[l] = next < count && sha1_lane_start( &lanes[l], state, l, input, ilen, next++ );
+
+    while( busy[0] || busy[1] || busy[2] || busy[3] || busy[4] || busy[5] || busy[6] || busy[7] )
+    {
+        for( int l = 0; l < 8; l++ )
+        {
+            const sha1_lane &lane = lanes[l];
+
+            if( !busy[l] )
+                data[l] = idle;
+            else if( lane.block < lane.full )
+                data[l] = input[lane.index] + lane.block * 64;
+            else
+                data[l] = lane.tail + ( lane.block - lane.full ) * 64;
+        }
+
+        sha1_avx2_process_x8( state, data );
+
+        for( int l = 0; l < 8; l++ )
+        {
+            if( !busy[l] || ++lanes[l].block < lanes[l].blocks )
+                continue;
+
+            for( int i = 0; i < 5; i++ )
+                PUT_UINT32_BE( state[i][l], output[lanes[l].index], i * 4 );
+
+            busy[l] = next < count && sha1_lane_start( &lanes[l], state, l, input, ilen, next++ );
+        }
+    }
+}
+#endif
+
+/*
+ * output[i] = SHA-1( input[i] ) for a batch of buffers
+ */
+void sha1_multi( const unsigned char *const input[], const size_t ilen[], unsigned char output[][20], size_t count )
+{
+#if defined(ARCH_X64)
+    // SHA-NI hashes one buffer faster than AVX2 hashes eight
+    if( !s_use_sha_ni && s_use_avx2 && count > 1 )
+    {
+        sha1_multi_avx2( input, ilen, output, count );
+        return;
+    }
+#endif
+
+    for( size_t i = 0; i < count; i++ )
+        sha1( input[i], ilen[i], output[i] );
+}
+
 /*
  * SHA-1 HMAC context setup
  */
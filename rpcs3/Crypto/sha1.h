@@ -112,6 +112,17 @@ void sha1( const unsigned char *input, size_t ilen, unsigned char output[20] );
  */
 int sha1_file( const char *path, unsigned char output[20] );
 
+/**
+ * \brief          Output[i] = SHA-1( input[i] ) for a batch of buffers,
+ *                 hashed several at once when SHA-NI is not available
+ *
+ * \param input    buffers holding the data
+ * \param ilen     lengths of the input data
+ * \param output   SHA-1 checksum results
+ * \param count    number of buffers
+ */
+void sha1_multi( const unsigned char *const input[], const size_t ilen[], unsigned char output[][20], size_t count );
+
 /**
  * \brief          SHA-1 HMAC context setup
  *
@@ -27,10 +27,17 @@
  */
 
 #include "sha256.h"
+#include "sha_simd.h"
 #include "utils.h"
 
+#include "util/sysinfo.hpp"
+
 #include <string.h>
 
+#if defined(ARCH_X64)
+static const bool s_use_sha_ni = utils::has_sha();
+#endif
+
 #if defined(MBEDTLS_SELF_TEST)
 #if defined(MBEDTLS_PLATFORM_C)
 #include "mbedtls/platform.h"
@@ -201,6 +208,14 @@ int mbedtls_internal_sha256_process( mbedtls_sha256_context *ctx,
     SHA256_VALIDATE_RET( ctx != NULL );
     SHA256_VALIDATE_RET( (const unsigned char *)data != NULL );
 
+#if defined(ARCH_X64)
+    if( s_use_sha_ni )
+    {
+        sha256_ni_process_blocks( ctx->state, data, 1 );
+        return( 0 );
+    }
+#endif
+
     for( i = 0; i < 8; i++ )
         A[i] = ctx->state[i];
 
@@ -299,6 +314,15 @@ int mbedtls_sha256_update_ret( mbedtls_sha256_context *ctx,
         left = 0;
     }
 
+#if defined(ARCH_X64)
+    if( s_use_sha_ni && ilen >= 64 )
+    {
+        sha256_ni_process_blocks( ctx->state, input, ilen / 64 );
+        input += ilen & ~size_t{63};
+        ilen  &= 63;
+    }
+#endif
+
     while( ilen >= 64 )
     {
         if( ( ret = mbedtls_internal_sha256_process( ctx, input ) ) != 0 )
@@ -0,0 +1,253 @@
+#include "sha_simd.h"
+#include "util/types.hpp"
+
+#if defined(ARCH_X64)
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define SHA_FUNC
+#define AVX2_FUNC
+#else
+#include <immintrin.h>
+#define SHA_FUNC __attribute__((__target__("sha,ssse3,sse4.1")))
+#define AVX2_FUNC __attribute__((__target__("avx2")))
+#endif
+
+alignas(16) static const uint32_t sha256_k[64] =
+{
+	0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+	0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+	0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+	0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+	0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+	0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+	0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+	0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+	0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+	0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+	0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+	0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+	0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+	0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+	0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+	0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+// Four SHA-1 rounds (group G of 20), the message schedule is kept in a ring of four vectors
+template <int G>
+SHA_FUNC static inline void sha1_ni_rounds(__m128i& abcd, __m128i& prev, __m128i e, __m128i (&msg)[4])
+{
+	if constexpr (G >= 4)
+	{
+		msg[G % 4] = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(msg[G % 4], msg[(G + 1) % 4]), msg[(G + 2) % 4]), msg[(G + 3) % 4]);
+	}
+
+	if constexpr (G == 0)
+	{
+		e = _mm_add_epi32(e, msg[0]);
+	}
+	else
+	{
+		e = _mm_sha1nexte_epu32(prev, msg[G % 4]);
+	}
+
+	prev = abcd;
+	abcd = _mm_sha1rnds4_epu32(abcd, e, G / 5);
+
+	if constexpr (G < 19)
+	{
+		sha1_ni_rounds<G + 1>(abcd, prev, e, msg);
+	}
+}
+
+SHA_FUNC void sha1_ni_process_blocks(uint32_t state[5], const unsigned char* data, size_t blocks)
+{
+	// Reverse the byte order of the whole vector (the first word goes to the highest lane)
+	const __m128i mask = _mm_set_epi64x(0x0001020304050607ull, 0x08090a0b0c0d0e0full);
+
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1b);
+	__m128i e = _mm_set_epi32(state[4], 0, 0, 0);
+
+	for (; blocks; blocks--, data += 64)
+	{
+		__m128i msg[4];
+
+		for (int i = 0; i < 4; i++)
+		{
+			msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)), mask);
+		}
+
+		const __m128i abcd_save = abcd;
+		__m128i prev = abcd;
+
+		sha1_ni_rounds<0>(abcd, prev, e, msg);
+
+		e = _mm_sha1nexte_epu32(prev, e);
+		abcd = _mm_add_epi32(abcd, abcd_save);
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1b));
+	state[4] = _mm_extract_epi32(e, 3);
+}
+
+// Four SHA-256 rounds (group G of 16)
+template <int G>
+SHA_FUNC static inline void sha256_ni_rounds(__m128i& state0, __m128i& state1, __m128i (&msg)[4])
+{
+	if constexpr (G >= 4)
+	{
+		const __m128i w7 = _mm_alignr_epi8(msg[(G + 3) % 4], msg[(G + 2) % 4], 4);
+		msg[G % 4] = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(msg[G % 4], msg[(G + 1) % 4]), w7), msg[(G + 3) % 4]);
+	}
+
+	__m128i wk = _mm_add_epi32(msg[G % 4], _mm_load_si128(reinterpret_cast<const __m128i*>(sha256_k + G * 4)));
+	state1 = _mm_sha256rnds2_epu32(state1, state0, wk);
+	wk = _mm_shuffle_epi32(wk, 0x0e);
+	state0 = _mm_sha256rnds2_epu32(state0, state1, wk);
+
+	if constexpr (G < 15)
+	{
+		sha256_ni_rounds<G + 1>(state0, state1, msg);
+	}
+}
+
+SHA_FUNC void sha256_ni_process_blocks(uint32_t state[8], const unsigned char* data, size_t blocks)
+{
+	// Reverse the byte order of each word
+	const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bull, 0x0405060700010203ull);
+
+	// The instructions use the ABEF/CDGH state layout
+	const __m128i dcba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+	const __m128i hgfe = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4));
+	const __m128i cdab = _mm_shuffle_epi32(dcba, 0xb1);
+	const __m128i efgh = _mm_shuffle_epi32(hgfe, 0x1b);
+
+	__m128i state0 = _mm_alignr_epi8(cdab, efgh, 8);
+	__m128i state1 = _mm_blend_epi16(efgh, cdab, 0xf0);
+
+	for (; blocks; blocks--, data += 64)
+	{
+		__m128i msg[4];
+
+		for (int i = 0; i < 4; i++)
+		{
+			msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16)), mask);
+		}
+
+		const __m128i abef_save = state0;
+		const __m128i cdgh_save = state1;
+
+		sha256_ni_rounds<0>(state0, state1, msg);
+
+		state0 = _mm_add_epi32(state0, abef_save);
+		state1 = _mm_add_epi32(state1, cdgh_save);
+	}
+
+	const __m128i feba = _mm_shuffle_epi32(state0, 0x1b);
+	const __m128i dchg = _mm_shuffle_epi32(state1, 0xb1);
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_blend_epi16(feba, dchg, 0xf0));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+}
+
+template <int N>
+AVX2_FUNC static inline __m256i sha1_avx2_rol(__m256i x)
+{
+	return _mm256_or_si256(_mm256_slli_epi32(x, N), _mm256_srli_epi32(x, 32 - N));
+}
+
+// Twenty SHA-1 rounds of all lanes with the round function of group G
+template <int G>
+AVX2_FUNC static inline void sha1_avx2_rounds(__m256i (&s)[5], __m256i (&w)[16])
+{
+	const __m256i k = _mm256_set1_epi32(G == 0 ? 0x5a827999 : G == 1 ? 0x6ed9eba1 : G == 2 ? 0x8f1bbcdc : 0xca62c1d6);
+
+	for (int t = G * 20; t < G * 20 + 20; t++)
+	{
+		if (t >= 16)
+		{
+			w[t % 16] = sha1_avx2_rol<1>(_mm256_xor_si256(_mm256_xor_si256(w[(t - 3) % 16], w[(t - 8) % 16]), _mm256_xor_si256(w[(t - 14) % 16], w[t % 16])));
+		}
+
+		__m256i f;
+
+		if constexpr (G == 0)
+		{
+			f = _mm256_xor_si256(s[3], _mm256_and_si256(s[1], _mm256_xor_si256(s[2], s[3])));
+		}
+		else if constexpr (G == 2)
+		{
+			f = _mm256_or_si256(_mm256_and_si256(s[1], s[2]), _mm256_and_si256(s[3], _mm256_or_si256(s[1], s[2])));
+		}
+		else
+		{
+			f = _mm256_xor_si256(s[1], _mm256_xor_si256(s[2], s[3]));
+		}
+
+		const __m256i temp = _mm256_add_epi32(_mm256_add_epi32(sha1_avx2_rol<5>(s[0]), f), _mm256_add_epi32(_mm256_add_epi32(s[4], k), w[t % 16]));
+
+		s[4] = s[3];
+		s[3] = s[2];
+		s[2] = sha1_avx2_rol<30>(s[1]);
+		s[1] = s[0];
+		s[0] = temp;
+	}
+}
+
+AVX2_FUNC void sha1_avx2_process_x8(uint32_t state[5][8], const unsigned char* const data[8])
+{
+	// Reverse the byte order of each word
+	const __m256i mask = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+
+	__m256i w[16];
+
+	// Transpose the message words (8 lanes by 8 words at once)
+	for (int half = 0; half < 2; half++)
+	{
+		__m256i r[8], t[8], u[8];
+
+		for (int l = 0; l < 8; l++)
+		{
+			r[l] = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data[l] + half * 32)), mask);
+		}
+
+		for (int l = 0; l < 8; l += 2)
+		{
+			t[l] = _mm256_unpacklo_epi32(r[l], r[l + 1]);
+			t[l + 1] = _mm256_unpackhi_epi32(r[l], r[l + 1]);
+		}
+
+		for (int l = 0; l < 8; l += 4)
+		{
+			u[l] = _mm256_unpacklo_epi64(t[l], t[l + 2]);
+			u[l + 1] = _mm256_unpackhi_epi64(t[l], t[l + 2]);
+			u[l + 2] = _mm256_unpacklo_epi64(t[l + 1], t[l + 3]);
+			u[l + 3] = _mm256_unpackhi_epi64(t[l + 1], t[l + 3]);
+		}
+
+		for (int i = 0; i < 4; i++)
+		{
+			w[half * 8 + i] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+			w[half * 8 + i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+		}
+	}
+
+	__m256i s[5], save[5];
+
+	for (int i = 0; i < 5; i++)
+	{
+		s[i] = save[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state[i]));
+	}
+
+	sha1_avx2_rounds<0>(s, w);
+	sha1_avx2_rounds<1>(s, w);
+	sha1_avx2_rounds<2>(s, w);
+	sha1_avx2_rounds<3>(s, w);
+
+	for (int i = 0; i < 5; i++)
+	{
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(state[i]), _mm256_add_epi32(s[i], save[i]));
+	}
+}
+
+#endif
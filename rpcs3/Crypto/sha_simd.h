@@ -0,0 +1,14 @@
+#pragma once
+
+// SHA extensions (SHA-NI) implementations of the SHA-1 and SHA-256 block functions, and a multi-buffer AVX2 SHA-1.
+// Only available on x86-64, check utils::has_sha() and utils::has_avx2() before calling them.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Process consecutive 64-byte blocks with SHA-NI
+void sha1_ni_process_blocks( uint32_t state[5], const unsigned char *data, size_t blocks );
+void sha256_ni_process_blocks( uint32_t state[8], const unsigned char *data, size_t blocks );
+
+// Process one 64-byte block for each of 8 independent messages (state is transposed: state[word][lane])
+void sha1_avx2_process_x8( uint32_t state[5][8], const unsigned char *const data[8] );
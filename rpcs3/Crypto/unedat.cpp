@@ -6,10 +6,13 @@
 #include "ec.h"
 
 #include "Utilities/mutex.h"
+#include "Utilities/Thread.h"
+#include "Emu/IdManager.h"
 #include "Emu/system_utils.hpp"
 #include <cmath>
 
 #include "util/asm.hpp"
+#include "util/sysinfo.hpp"
 
 LOG_CHANNEL(edat_log, "EDAT");
 
@@ -157,28 +160,30 @@ u128 get_block_key(int block, NPD_HEADER *npd)
 	return dest_key;
 }
 
-// for out data, allocate a buffer the size of 'edat->block_size'
-// Also, set 'in file' to the beginning of the encrypted data, which may be offset if inside another file, but normally just reset to beginning of file
-// returns number of bytes written, -1 for error
-s64 decrypt_block(const fs::file* in, u8* out, EDAT_HEADER *edat, NPD_HEADER *npd, u8* crypt_key, u32 block_num, u32 total_blocks, u64 size_left)
+// Encrypted block data and its metadata, read separately from decryption so that decryption can run on any thread
+struct edat_encrypted_block
+{
+	u64 offset = 0;
+	s32 pad_length = 0;
+	s32 compression_end = 0;
+	u8 hash_result[0x14]{};
+	std::unique_ptr<u8[]> enc_data;
+};
+
+// Set 'in file' to the beginning of the encrypted data, which may be offset if inside another file, but normally just reset to beginning of file
+static void read_block(const fs::file* in, edat_encrypted_block& block, EDAT_HEADER *edat, u32 block_num, u32 total_blocks, NPD_HEADER *npd)
 {
 	// Get metadata info and setup buffers.
 	const int metadata_section_size = ((edat->flags & EDAT_COMPRESSED_FLAG) != 0 || (edat->flags & EDAT_FLAG_0x20) != 0) ? 0x20 : 0x10;
 	const int metadata_offset = 0x100;
 
-	std::unique_ptr<u8[]> enc_data;
-	std::unique_ptr<u8[]> dec_data;
-	u8 hash[0x10] = { 0 };
-	u8 key_result[0x10] = { 0 };
-	u8 hash_result[0x14] = { 0 };
-
 	u64 offset = 0;
 	u64 metadata_sec_offset = 0;
 	s32 length = 0;
 	s32 compression_end = 0;
-	unsigned char empty_iv[0x10] = {};
 
 	const u64 file_offset = in->pos();
+	u8* hash_result = block.hash_result;
 	memset(hash_result, 0, 0x14);
 
 	// Decrypt the metadata.
@@ -242,17 +247,32 @@ s64 decrypt_block(const fs::file* in, u8* out, EDAT_HEADER *edat, NPD_HEADER *np
 	}
 
 	// Locate the real data.
-	const int pad_length = length;
-	length = (pad_length + 0xF) & 0xFFFFFFF0;
+	block.offset = offset;
+	block.pad_length = length;
+	block.compression_end = compression_end;
+	length = (length + 0xF) & 0xFFFFFFF0;
 
-	// Setup buffers for decryption and read the data.
-	enc_data.reset(new u8[length]{ 0 });
-	dec_data.reset(new u8[length]{ 0 });
-	memset(hash, 0, 0x10);
-	memset(key_result, 0, 0x10);
+	// Setup buffer for decryption and read the data.
+	block.enc_data.reset(new u8[length]{ 0 });
 
 	in->seek(file_offset + offset);
-	in->read(enc_data.get(), length);
+	in->read(block.enc_data.get(), length);
+}
+
+// for out data, allocate a buffer the size of 'edat->block_size'
+// returns number of bytes written, -1 for error
+static s64 decrypt_read_block(edat_encrypted_block& block, u8* out, EDAT_HEADER *edat, NPD_HEADER *npd, u8* crypt_key, u32 block_num, u64 size_left)
+{
+	const u64 offset = block.offset;
+	const int pad_length = block.pad_length;
+	const int length = (pad_length + 0xF) & 0xFFFFFFF0;
+	const s32 compression_end = block.compression_end;
+	u8* hash_result = block.hash_result;
+
+	std::unique_ptr<u8[]> dec_data(new u8[length]{ 0 });
+	u8 hash[0x10] = { 0 };
+	u8 key_result[0x10] = { 0 };
+	unsigned char empty_iv[0x10] = {};
 
 	// Generate a key for the current block.
 	auto b_key = get_block_key(block_num, npd);
@@ -287,14 +307,14 @@ s64 decrypt_block(const fs::file* in, u8* out, EDAT_HEADER *edat, NPD_HEADER *np
 		crypto_mode |= 0x01000000;
 		hash_mode |= 0x01000000;
 		// Simply copy the data without the header or the footer.
-		memcpy(dec_data.get(), enc_data.get(), length);
+		memcpy(dec_data.get(), block.enc_data.get(), length);
 	}
 	else
 	{
 		// IV is null if NPD version is 1 or 0.
 		u8* iv = (npd->version <= 1) ? empty_iv : npd->digest;
 		// Call main crypto routine on this data block.
-		if (!decrypt(hash_mode, crypto_mode, (npd->version == 4), enc_data.get(), dec_data.get(), length, key_result, iv, hash, hash_result))
+		if (!decrypt(hash_mode, crypto_mode, (npd->version == 4), block.enc_data.get(), dec_data.get(), length, key_result, iv, hash, hash_result))
 		{
 			edat_log.error("Block at offset 0x%llx has invalid hash!", offset);
 			return -1;
@@ -325,6 +345,16 @@ s64 decrypt_block(const fs::file* in, u8* out, EDAT_HEADER *edat, NPD_HEADER *np
 	}
 }
 
+// for out data, allocate a buffer the size of 'edat->block_size'
+// Also, set 'in file' to the beginning of the encrypted data, which may be offset if inside another file, but normally just reset to beginning of file
+// returns number of bytes written, -1 for error
+s64 decrypt_block(const fs::file* in, u8* out, EDAT_HEADER *edat, NPD_HEADER *npd, u8* crypt_key, u32 block_num, u32 total_blocks, u64 size_left)
+{
+	edat_encrypted_block block;
+	read_block(in, block, edat, block_num, total_blocks, npd);
+	return decrypt_read_block(block, out, edat, npd, crypt_key, block_num, size_left);
+}
+
 // EDAT/SDAT decryption.
 // reset file to beginning of data before calling
 int decrypt_data(const fs::file* in, const fs::file* out, EDAT_HEADER *edat, NPD_HEADER *npd, unsigned char* crypt_key, bool /*verbose*/)
@@ -894,6 +924,188 @@ fs::file DecryptEDAT(const fs::file& input, const std::string& input_file_name,
 	return output;
 }
 
+// Worker threads shared by all EDAT/SDATA files, used for parallel and background block decryption
+struct edat_decrypt_pool
+{
+	struct worker
+	{
+		lf_queue<std::function<void()>> queue;
+
+		void operator()()
+		{
+			while (thread_ctrl::state() != thread_state::aborting)
+			{
+				for (auto&& task : queue.pop_all())
+				{
+					task();
+				}
+
+				thread_ctrl::wait_on(queue, nullptr);
+			}
+
+			// Tasks queued right before shutdown may still be waited for
+			for (auto&& task : queue.pop_all())
+			{
+				task();
+			}
+		}
+	};
+
+	static constexpr u32 max_workers = 4;
+
+	shared_mutex mutex;
+	bool closed = false;
+	u32 next = 0;
+	std::unique_ptr<named_thread_group<worker>> workers;
+
+	// Queue a task on one of the workers, returns false if the pool is shutting down
+	bool push(std::function<void()> task)
+	{
+		std::lock_guard lock(mutex);
+
+		if (closed)
+		{
+			return false;
+		}
+
+		if (!workers)
+		{
+			workers = std::make_unique<named_thread_group<worker>>("EDAT Worker ", std::clamp<u32>(utils::get_thread_count() / 2, 1, max_workers));
+		}
+
+		(workers->begin() + next++ % workers->size())->queue.push(std::move(task));
+		return true;
+	}
+
+	~edat_decrypt_pool()
+	{
+		{
+			std::lock_guard lock(mutex);
+			closed = true;
+		}
+
+		workers.reset();
+	}
+};
+
+// Call func(i) for every i in [0, count), sharing the work between the calling thread and the pool
+static void run_parallel(u32 count, const std::function<void(u32)>& func)
+{
+	struct shared_state
+	{
+		atomic_t<u32> next = 0;
+		atomic_t<u32> active = 0;
+	};
+
+	const auto state = std::make_shared<shared_state>();
+
+	const auto process = [state, count, &func]()
+	{
+		for (u32 i = state->next++; i < count; i = state->next++)
+		{
+			func(i);
+		}
+	};
+
+	if (const auto pool = count > 1 ? g_fxo->try_get<edat_decrypt_pool>() : nullptr)
+	{
+		for (u32 i = 0; i < std::min(count - 1, edat_decrypt_pool::max_workers); i++)
+		{
+			state->active++;
+
+			const bool queued = pool->push([state, process]()
+			{
+				process();
+
+				if (!--state->active)
+				{
+					state->active.notify_all();
+				}
+			});
+
+			if (!queued)
+			{
+				state->active--;
+				break;
+			}
+		}
+	}
+
+	process();
+
+	// func is referenced by the tasks until they finish
+	while (const u32 active = state->active)
+	{
+		state->active.wait(active);
+	}
+}
+
+struct EDATADecrypter::block_cache
+{
+	struct entry
+	{
+		u32 block = umax;
+		u64 last_use = 0;
+		std::vector<u8> data;
+	};
+
+	shared_mutex mutex;
+	std::vector<entry> entries;
+	const usz limit;
+	u64 use_counter = 0;
+
+	// Blocks being decrypted in the background
+	u32 readahead_begin = 0;
+	u32 readahead_end = 0;
+	atomic_t<u32> readahead_pending = 0;
+
+	explicit block_cache(usz limit)
+		: limit(limit)
+	{
+	}
+
+	entry* find(u32 block)
+	{
+		for (entry& e : entries)
+		{
+			if (e.block == block)
+			{
+				e.last_use = ++use_counter;
+				return &e;
+			}
+		}
+
+		return nullptr;
+	}
+
+	void insert(u32 block, std::vector<u8>&& data)
+	{
+		if (find(block))
+		{
+			return;
+		}
+
+		entry* e = nullptr;
+
+		if (entries.size() < limit)
+		{
+			e = &entries.emplace_back();
+		}
+		else
+		{
+			// Evict the least recently used block
+			e = &*std::min_element(entries.begin(), entries.end(), [](const entry& a, const entry& b)
+			{
+				return a.last_use < b.last_use;
+			});
+		}
+
+		e->block = block;
+		e->last_use = ++use_counter;
+		e->data = std::move(data);
+	}
+};
+
 bool EDATADecrypter::ReadHeader()
 {
 	edata_file.seek(0);
@@ -933,8 +1145,25 @@ bool EDATADecrypter::ReadHeader()
 		return false;
 	}*/
 
+	if (edatHeader.block_size <= 0)
+	{
+		edat_log.error("Invalid block size (0x%x)", edatHeader.block_size);
+		return false;
+	}
+
+	const u64 block_count = utils::aligned_div<u64>(edatHeader.file_size, edatHeader.block_size);
+
+	if (block_count > u32{umax})
+	{
+		edat_log.error("Invalid file size (0x%llx, block size 0x%x)", edatHeader.file_size, edatHeader.block_size);
+		return false;
+	}
+
 	file_size = edatHeader.file_size;
-	total_blocks = utils::aligned_div(edatHeader.file_size, edatHeader.block_size);
+	total_blocks = static_cast<u32>(block_count);
+
+	// Keep up to 1MB of decrypted data per file
+	m_cache = std::make_shared<block_cache>(std::max<usz>(0x100000 / edatHeader.block_size, 4));
 
 	// Try decrypting the first block instead
 	u8 data_sample[1];
@@ -960,28 +1189,178 @@ u64 EDATADecrypter::ReadData(u64 pos, u8* data, u64 size)
 	const u64 startOffset = pos % edatHeader.block_size;
 
 	const u64 num_blocks = utils::aligned_div(startOffset + size, edatHeader.block_size);
-	data_buf.resize(num_blocks * edatHeader.block_size);
 
 	// Find and decrypt block range covering pos + size
 	const u32 starting_block = ::narrow<u32>(pos / edatHeader.block_size);
 	const u32 ending_block = ::narrow<u32>(std::min<u64>(starting_block + num_blocks, total_blocks));
-	u64 writeOffset = 0;
 
-	for (u32 i = starting_block; i < ending_block; ++i)
+	// End of the data written so far, relative to pos
+	u64 bytesWrote = 0;
+
+	const auto copy_block = [&](u32 block, const u8* src, u64 length)
 	{
-		edata_file.seek(0);
-		u64 res = decrypt_block(&edata_file, &data_buf[writeOffset], &edatHeader, &npdHeader, reinterpret_cast<uchar*>(&dec_key), i, total_blocks, edatHeader.file_size);
-		if (res == umax)
+		// Blocks are decrypted to block_size bytes, except the last one
+		const u64 block_pos = u64{block} * edatHeader.block_size;
+		const u64 begin = std::max(block_pos, pos);
+		const u64 end = std::min(block_pos + length, pos + size);
+
+		if (begin < end)
 		{
-			edat_log.error("Error Decrypting data");
-			return 0;
+			std::memcpy(data + (begin - pos), src + (begin - block_pos), end - begin);
+			bytesWrote = std::max(bytesWrote, end - pos);
 		}
+	};
 
-		writeOffset += res;
+	std::vector<u32> missing;
+	{
+		std::unique_lock lock(m_cache->mutex);
+
+		// Wait for the background job if it decrypts any of the requested blocks
+		while (m_cache->readahead_pending && starting_block < m_cache->readahead_end && ending_block > m_cache->readahead_begin)
+		{
+			lock.unlock();
+			m_cache->readahead_pending.wait(1);
+			lock.lock();
+		}
+
+		for (u32 i = starting_block; i < ending_block; ++i)
+		{
+			if (const auto found = m_cache->find(i))
+			{
+				copy_block(i, found->data.data(), found->data.size());
+			}
+			else
+			{
+				missing.push_back(i);
+			}
+		}
 	}
 
-	const u64 bytesWrote = std::min<u64>(writeOffset - startOffset, size);
+	if (!missing.empty())
+	{
+		// The file is only accessed from this thread, read everything before decrypting
+		std::vector<edat_encrypted_block> blocks(missing.size());
+
+		for (usz i = 0; i < missing.size(); i++)
+		{
+			edata_file.seek(0);
+			read_block(&edata_file, blocks[i], &edatHeader, missing[i], total_blocks, &npdHeader);
+		}
+
+		std::vector<std::vector<u8>> results(missing.size());
+		std::vector<s64> sizes(missing.size());
+
+		run_parallel(::size32(missing), [&](u32 i)
+		{
+			results[i].resize(edatHeader.block_size);
+			sizes[i] = decrypt_read_block(blocks[i], results[i].data(), &edatHeader, &npdHeader, reinterpret_cast<uchar*>(&dec_key), missing[i], edatHeader.file_size);
+			results[i].resize(std::max<s64>(sizes[i], 0));
+		});
+
+		std::lock_guard lock(m_cache->mutex);
+
+		for (usz i = 0; i < missing.size(); i++)
+		{
+			if (sizes[i] < 0)
+			{
+				edat_log.error("Error Decrypting data");
+				return 0;
+			}
+
+			copy_block(missing[i], results[i].data(), results[i].size());
+			m_cache->insert(missing[i], std::move(results[i]));
+		}
+	}
+
+	// Keep the next blocks decrypted ahead of a sequential reader
+	m_sequential_reads = starting_block == m_next_block || starting_block + 1 == m_next_block ? m_sequential_reads + 1 : 0;
+	m_next_block = ending_block;
+
+	if (m_sequential_reads >= 2 && ending_block < total_blocks)
+	{
+		read_ahead(ending_block);
+	}
 
-	memcpy(data, &data_buf[startOffset], bytesWrote);
 	return bytesWrote;
 }
+
+void EDATADecrypter::read_ahead(u32 start_block)
+{
+	const auto pool = g_fxo->try_get<edat_decrypt_pool>();
+
+	if (!pool || m_cache->readahead_pending)
+	{
+		return;
+	}
+
+	const u32 end_block = ::narrow<u32>(std::min<u64>(u64{start_block} + m_cache->limit / 2, total_blocks));
+
+	std::vector<std::pair<u32, edat_encrypted_block>> blocks;
+	{
+		std::lock_guard lock(m_cache->mutex);
+
+		for (u32 i = start_block; i < end_block; i++)
+		{
+			if (!m_cache->find(i))
+			{
+				blocks.emplace_back(i, edat_encrypted_block{});
+			}
+		}
+
+		if (blocks.empty())
+		{
+			return;
+		}
+
+		m_cache->readahead_begin = blocks.front().first;
+		m_cache->readahead_end = blocks.back().first + 1;
+		m_cache->readahead_pending.release(1);
+	}
+
+	// Only the decryption runs in the background, the file must not be accessed from another thread
+	for (auto& [block, enc] : blocks)
+	{
+		edata_file.seek(0);
+		read_block(&edata_file, enc, &edatHeader, block, total_blocks, &npdHeader);
+	}
+
+	// The job owns everything it uses, the file may be closed before it runs
+	const auto job = std::make_shared<decltype(blocks)>(std::move(blocks));
+
+	const bool queued = pool->push([cache = m_cache, job, edat = edatHeader, npd = npdHeader, key = dec_key]() mutable
+	{
+		std::vector<std::pair<u32, std::vector<u8>>> results;
+
+		for (auto& [block, enc] : *job)
+		{
+			std::vector<u8> out(edat.block_size);
+			const s64 res = decrypt_read_block(enc, out.data(), &edat, &npd, reinterpret_cast<uchar*>(&key), block, edat.file_size);
+
+			if (res < 0)
+			{
+				// The reader decrypts this block again and reports the error
+				break;
+			}
+
+			out.resize(res);
+			results.emplace_back(block, std::move(out));
+		}
+
+		{
+			std::lock_guard lock(cache->mutex);
+
+			for (auto& [block, out] : results)
+			{
+				cache->insert(block, std::move(out));
+			}
+		}
+
+		cache->readahead_pending.release(0);
+		cache->readahead_pending.notify_all();
+	});
+
+	if (!queued)
+	{
+		m_cache->readahead_pending.release(0);
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <memory>
 
 #include "utils.h"
 
@@ -79,11 +80,18 @@ struct EDATADecrypter final : fs::file_base
 	NPD_HEADER npdHeader{};
 	EDAT_HEADER edatHeader{};
 
-	// Internal data buffers.
-	std::vector<u8> data_buf{};
-
 	u128 dec_key{};
 
+	// Decrypted blocks, shared with the background read-ahead jobs
+	struct block_cache;
+	std::shared_ptr<block_cache> m_cache;
+
+	// Sequential access detection: block following the previous request and number of sequential requests so far
+	u32 m_next_block = 0;
+	u32 m_sequential_reads = 0;
+
+	void read_ahead(u32 start_block);
+
 public:
 	EDATADecrypter(fs::file&& input, u128 dec_key = {})
 		: edata_file(std::move(input))
@@ -1,9 +1,14 @@
 #include "stdafx.h"
 #include "Emu/VFS.h"
+#include "Emu/IdManager.h"
 #include "Emu/Cell/PPUModule.h"
+#include "Utilities/mutex.h"
 
 #include <stb_truetype.h>
 
+#include <list>
+#include <unordered_map>
+
 #include "cellFont.h"
 
 LOG_CHANNEL(cellFont);
@@ -46,6 +51,172 @@ void fmt_class_string<CellFontError>::format(std::string& out, u64 arg)
 	});
 }
 
+// Font metrics and rasterized glyphs, keyed by the font data (shared by font instances)
+struct font_glyph_cache
+{
+	static constexpr usz max_bitmaps = 4096;
+
+	struct vmetrics
+	{
+		s32 ascent, descent, line_gap;
+	};
+
+	struct glyph_box
+	{
+		s32 x0, y0, x1, y1;
+		s32 advance, lsb;
+	};
+
+	struct glyph_bitmap
+	{
+		s32 width = 0, height = 0, xoff = 0, yoff = 0;
+		std::vector<u8> data; // Empty if there is nothing to draw
+	};
+
+	struct font_entry
+	{
+		vmetrics vm{};
+		std::unordered_map<u32, glyph_box> boxes;
+	};
+
+	struct bitmap_key
+	{
+		const u8* font;
+		u32 scale; // Bits of the pixel height
+		u32 code;
+
+		bool operator==(const bitmap_key&) const = default;
+	};
+
+	struct bitmap_key_hash
+	{
+		usz operator()(const bitmap_key& key) const
+		{
+			return std::hash<const u8*>()(key.font) ^ (u64{key.scale} << 32 | key.code) * 0x9e3779b97f4a7c15;
+		}
+	};
+
+	using lru_list = std::list<std::pair<bitmap_key, std::shared_ptr<const glyph_bitmap>>>;
+
+	shared_mutex mutex;
+	std::unordered_map<const u8*, font_entry> fonts;
+	lru_list bitmaps; // Most recently used first
+	std::unordered_map<bitmap_key, lru_list::iterator, bitmap_key_hash> bitmap_map;
+
+	atomic_t<u64> hits = 0;
+	atomic_t<u64> misses = 0;
+
+	~font_glyph_cache()
+	{
+		if (hits || misses)
+		{
+			cellFont.notice("Glyph cache: %u hits, %u misses", hits.load(), misses.load());
+		}
+	}
+
+	font_entry& get_font(const stbtt_fontinfo* info)
+	{
+		auto [found, inserted] = fonts.try_emplace(info->data);
+
+		if (inserted)
+		{
+			auto& vm = found->second.vm;
+			stbtt_GetFontVMetrics(info, &vm.ascent, &vm.descent, &vm.line_gap);
+		}
+
+		return found->second;
+	}
+
+	vmetrics get_vmetrics(const stbtt_fontinfo* info)
+	{
+		std::lock_guard lock(mutex);
+		return get_font(info).vm;
+	}
+
+	glyph_box get_box(const stbtt_fontinfo* info, u32 code)
+	{
+		std::lock_guard lock(mutex);
+
+		auto& boxes = get_font(info).boxes;
+		auto [found, inserted] = boxes.try_emplace(code);
+
+		if (inserted)
+		{
+			auto& box = found->second;
+			stbtt_GetCodepointBox(info, code, &box.x0, &box.y0, &box.x1, &box.y1);
+			stbtt_GetCodepointHMetrics(info, code, &box.advance, &box.lsb);
+		}
+
+		return found->second;
+	}
+
+	std::shared_ptr<const glyph_bitmap> get_bitmap(const stbtt_fontinfo* info, float pixel_height, float scale, u32 code)
+	{
+		const bitmap_key key{info->data, std::bit_cast<u32>(pixel_height), code};
+
+		{
+			std::lock_guard lock(mutex);
+
+			if (const auto found = bitmap_map.find(key); found != bitmap_map.end())
+			{
+				bitmaps.splice(bitmaps.begin(), bitmaps, found->second);
+				hits++;
+				return found->second->second;
+			}
+		}
+
+		misses++;
+
+		// Rasterize without holding the lock
+		auto bitmap = std::make_shared<glyph_bitmap>();
+
+		if (u8* box = stbtt_GetCodepointBitmap(info, scale, scale, code, &bitmap->width, &bitmap->height, &bitmap->xoff, &bitmap->yoff))
+		{
+			bitmap->data.assign(box, box + usz(bitmap->width) * bitmap->height);
+			stbtt_FreeBitmap(box, nullptr);
+		}
+
+		std::lock_guard lock(mutex);
+
+		if (const auto found = bitmap_map.find(key); found != bitmap_map.end())
+		{
+			// Rasterized concurrently
+			return found->second->second;
+		}
+
+		if (bitmaps.size() >= max_bitmaps)
+		{
+			bitmap_map.erase(bitmaps.back().first);
+			bitmaps.pop_back();
+		}
+
+		bitmaps.emplace_front(key, bitmap);
+		bitmap_map.emplace(key, bitmaps.begin());
+		return bitmap;
+	}
+
+	// Forget everything about the font data (closed, or reused for another font)
+	void erase(const u8* font)
+	{
+		std::lock_guard lock(mutex);
+
+		fonts.erase(font);
+
+		for (auto it = bitmaps.begin(); it != bitmaps.end();)
+		{
+			if (it->first.font == font)
+			{
+				bitmap_map.erase(it->first);
+				it = bitmaps.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+};
+
 // Functions
 error_code cellFontInitializeWithRevision(u64 revisionFlags, vm::ptr<CellFontConfig> config)
 {
@@ -90,6 +261,9 @@ error_code cellFontOpenFontMemory(vm::ptr<CellFontLibrary> library, u32 fontAddr
 
 	font->stbfont = vm::_ptr<stbtt_fontinfo>(font.addr() + font.size()); // hack: use next bytes of the struct
 
+	// The memory may have held another font
+	g_fxo->get<font_glyph_cache>().erase(vm::_ptr<u8>(fontAddr));
+
 	if (!stbtt_InitFont(font->stbfont, vm::_ptr<unsigned char>(fontAddr), 0))
 		return CELL_FONT_ERROR_FONT_OPEN_FAILED;
 
@@ -263,9 +437,8 @@ error_code cellFontGetHorizontalLayout(vm::ptr<CellFont> font, vm::ptr<CellFontH
 {
 	cellFont.trace("cellFontGetHorizontalLayout(font=*0x%x, layout=*0x%x)", font, layout);
 
-	s32 ascent, descent, lineGap;
-	float scale = stbtt_ScaleForPixelHeight(font->stbfont, font->scale_y);
-	stbtt_GetFontVMetrics(font->stbfont, &ascent, &descent, &lineGap);
+	const float scale = stbtt_ScaleForPixelHeight(font->stbfont, font->scale_y);
+	const auto [ascent, descent, lineGap] = g_fxo->get<font_glyph_cache>().get_vmetrics(font->stbfont);
 
 	layout->baseLineY = ascent * scale;
 	layout->lineHeight = (ascent-descent+lineGap) * scale;
@@ -343,20 +516,22 @@ error_code cellFontRenderCharGlyphImage(vm::ptr<CellFont> font, u32 code, vm::pt
 		return CELL_FONT_ERROR_RENDERER_UNBIND;
 	}
 
-	// Render the character
-	s32 width, height, xoff, yoff;
-	float scale = stbtt_ScaleForPixelHeight(font->stbfont, font->scale_y);
-	unsigned char* box = stbtt_GetCodepointBitmap(font->stbfont, scale, scale, code, &width, &height, &xoff, &yoff);
+	auto& cache = g_fxo->get<font_glyph_cache>();
+
+	// Render the character (or reuse the cached bitmap)
+	const float scale = stbtt_ScaleForPixelHeight(font->stbfont, font->scale_y);
+	const auto glyph = cache.get_bitmap(font->stbfont, font->scale_y, scale, code);
 
-	if (!box)
+	if (glyph->data.empty())
 	{
 		return CELL_OK;
 	}
 
+	const auto [width, height, xoff, yoff] = std::tie(glyph->width, glyph->height, glyph->xoff, glyph->yoff);
+	const u8* box = glyph->data.data();
+
 	// Get the baseLineY value
-	s32 ascent, descent, lineGap;
-	stbtt_GetFontVMetrics(font->stbfont, &ascent, &descent, &lineGap);
-	const s32 baseLineY = static_cast<int>(ascent * scale); // ???
+	const s32 baseLineY = static_cast<int>(cache.get_vmetrics(font->stbfont).ascent * scale); // ???
 
 	// Move the rendered character to the surface
 	unsigned char* buffer = vm::_ptr<unsigned char>(surface->buffer.addr());
@@ -374,7 +549,7 @@ error_code cellFontRenderCharGlyphImage(vm::ptr<CellFont> font, u32 code, vm::pt
 			buffer[(static_cast<s32>(y) + ypos + yoff + baseLineY) * surface->width + static_cast<s32>(x) + xpos] = box[ypos * width + xpos];
 		}
 	}
-	stbtt_FreeBitmap(box, nullptr);
+
 	return CELL_OK;
 }
 
@@ -423,6 +598,7 @@ error_code cellFontCloseFont(vm::ptr<CellFont> font)
 		font->origin == CELL_FONT_OPEN_FONT_FILE ||
 		font->origin == CELL_FONT_OPEN_MEMORY)
 	{
+		g_fxo->get<font_glyph_cache>().erase(vm::_ptr<u8>(font->fontdata_addr));
 		vm::dealloc(font->fontdata_addr, vm::main);
 	}
 
@@ -433,11 +609,8 @@ error_code cellFontGetCharGlyphMetrics(vm::ptr<CellFont> font, u32 code, vm::ptr
 {
 	cellFont.warning("cellFontGetCharGlyphMetrics(font=*0x%x, code=0x%x, metrics=*0x%x)", font, code, metrics);
 
-	s32 x0, y0, x1, y1;
-	s32 advanceWidth, leftSideBearing;
-	float scale = stbtt_ScaleForPixelHeight(font->stbfont, font->scale_y);
-	stbtt_GetCodepointBox(font->stbfont, code, &x0, &y0, &x1, &y1);
-	stbtt_GetCodepointHMetrics(font->stbfont, code, &advanceWidth, &leftSideBearing);
+	const float scale = stbtt_ScaleForPixelHeight(font->stbfont, font->scale_y);
+	const auto [x0, y0, x1, y1, advanceWidth, leftSideBearing] = g_fxo->get<font_glyph_cache>().get_box(font->stbfont, code);
 
 	// TODO: Add the rest of the information
 	metrics->width = (x1-x0) * scale;
@@ -915,13 +915,10 @@ struct fs_aio_thread : ppu_thread
 			}
 			else if (std::lock_guard lock(file->mp->mutex); file->file)
 			{
-				const auto old_pos = file->file.pos(); file->file.seek(aio->offset);
-
 				result = type == 2
-					? file->op_write(aio->buf, aio->size)
-					: file->op_read(aio->buf, aio->size);
+					? lv2_file::op_write(file->file, aio->offset, aio->buf, aio->size)
+					: lv2_file::op_read(file->file, aio->offset, aio->buf, aio->size);
 
-				file->file.seek(old_pos);
 				error = CELL_OK;
 			}
 
@@ -3,11 +3,9 @@
 #include "Emu/IdManager.h"
 #include "Emu/Cell/PPUModule.h"
 
-// STB_IMAGE_IMPLEMENTATION is already defined in stb_image.cpp
-#include <stb_image.h>
-
 #include "Emu/Cell/lv2/sys_fs.h"
 #include "cellGifDec.h"
+#include "image_decoder.h"
 
 #include "util/asm.hpp"
 
@@ -76,10 +74,14 @@ error_code cellGifDecOpen(PMainHandle mainHandle, PPSubHandle subHandle, PSrc sr
 	current_subHandle.fd = 0;
 	current_subHandle.src = *src;
 
+	// Decoding starts in the background as soon as the stream is available
+	std::vector<u8> stream;
+
 	switch (src->srcSelect)
 	{
 	case CELL_GIFDEC_BUFFER:
 		current_subHandle.fileSize = src->streamSize;
+		stream.assign(vm::_ptr<u8>(src->streamPtr.addr()), vm::_ptr<u8>(src->streamPtr.addr()) + src->streamSize);
 		break;
 
 	case CELL_GIFDEC_FILE:
@@ -90,6 +92,7 @@ error_code cellGifDecOpen(PMainHandle mainHandle, PPSubHandle subHandle, PSrc sr
 		if (!file_s) return CELL_GIFDEC_ERROR_OPEN_FILE;
 
 		current_subHandle.fileSize = file_s.size();
+		stream = file_s.to_vector<u8>();
 		current_subHandle.fd = idm::make<lv2_fs_object, lv2_file>(src->fileName.get_ptr(), std::move(file_s), 0, 0, real_path);
 		break;
 	}
@@ -100,6 +103,11 @@ error_code cellGifDecOpen(PMainHandle mainHandle, PPSubHandle subHandle, PSrc sr
 
 	**subHandle = current_subHandle;
 
+	if (!stream.empty())
+	{
+		image_decoder_prefetch(image_decoder_type::gif, mainHandle.addr(), subHandle->addr(), std::move(stream));
+	}
+
 	return CELL_OK;
 }
 
@@ -203,36 +211,41 @@ error_code cellGifDecDecodeData(PMainHandle mainHandle, PSubHandle subHandle, vm
 	const u64 fileSize = subHandle->fileSize;
 	const CellGifDecOutParam& current_outParam = subHandle->outParam;
 
-	//Copy the GIF file to a buffer
-	std::unique_ptr<u8[]> gif(new u8[fileSize]);
+	std::shared_ptr<const decoded_image> image;
 
-	switch (subHandle->src.srcSelect)
+	// Use the result decoded in the background if the stream was prefetched on open
+	if (!image_decoder_take(image_decoder_type::gif, subHandle.addr(), image))
 	{
-	case CELL_GIFDEC_BUFFER:
-		std::memcpy(gif.get(), subHandle->src.streamPtr.get_ptr(), fileSize);
-		break;
+		//Copy the GIF file to a buffer
+		std::vector<u8> gif(fileSize);
 
-	case CELL_GIFDEC_FILE:
-	{
-		auto file = idm::get<lv2_fs_object, lv2_file>(fd);
-		file->file.seek(0);
-		file->file.read(gif.get(), fileSize);
-		break;
-	}
-	default: break; // TODO
-	}
+		switch (subHandle->src.srcSelect)
+		{
+		case CELL_GIFDEC_BUFFER:
+			std::memcpy(gif.data(), subHandle->src.streamPtr.get_ptr(), fileSize);
+			break;
 
-	//Decode GIF file. (TODO: Is there any faster alternative? Can we do it without external libraries?)
-	int width, height, actual_components;
-	auto image = std::unique_ptr<unsigned char,decltype(&::free)>
-		(
-			stbi_load_from_memory(gif.get(), ::narrow<int>(fileSize), &width, &height, &actual_components, 4),
-			&::free
-		);
+		case CELL_GIFDEC_FILE:
+		{
+			auto file = idm::get<lv2_fs_object, lv2_file>(fd);
+			file->file.seek(0);
+			file->file.read(gif.data(), fileSize);
+			break;
+		}
+		default: break; // TODO
+		}
+
+		//Decode GIF file. (TODO: Is there any faster alternative? Can we do it without external libraries?)
+		image = image_decode(gif);
+	}
 
 	if (!image)
 		return CELL_GIFDEC_ERROR_STREAM_FORMAT;
 
+	const int width = image->width;
+	const int height = image->height;
+	const u8* pixels = image->pixels.data();
+
 	const int bytesPerLine = static_cast<int>(dataCtrlParam->outputBytesPerLine);
 	const char nComponents = 4;
 	uint image_size = width * height * nComponents;
@@ -248,12 +261,12 @@ error_code cellGifDecDecodeData(PMainHandle mainHandle, PSubHandle subHandle, vm
 			{
 				const int dstOffset = i * bytesPerLine;
 				const int srcOffset = width * nComponents * i;
-				memcpy(&data[dstOffset], &image.get()[srcOffset], linesize);
+				memcpy(&data[dstOffset], &pixels[srcOffset], linesize);
 			}
 		}
 		else
 		{
-			memcpy(data.get_ptr(), image.get(), image_size);
+			memcpy(data.get_ptr(), pixels, image_size);
 		}
 	}
 	break;
@@ -262,36 +275,17 @@ error_code cellGifDecDecodeData(PMainHandle mainHandle, PSubHandle subHandle, vm
 	{
 		if (bytesPerLine > width * nComponents) // Check if we need padding
 		{
-			//TODO: find out if we can't do padding without an extra copy
 			const int linesize = std::min(bytesPerLine, width * nComponents);
-			const auto output = std::make_unique<char[]>(linesize);
 			for (int i = 0; i < height; i++)
 			{
 				const int dstOffset = i * bytesPerLine;
 				const int srcOffset = width * nComponents * i;
-				for (int j = 0; j < linesize; j += nComponents)
-				{
-					output[j + 0] = image.get()[srcOffset + j + 3];
-					output[j + 1] = image.get()[srcOffset + j + 0];
-					output[j + 2] = image.get()[srcOffset + j + 1];
-					output[j + 3] = image.get()[srcOffset + j + 2];
-				}
-				std::memcpy(&data[dstOffset], output.get(), linesize);
+				image_rgba_to_argb(&data[dstOffset], &pixels[srcOffset], linesize / nComponents);
 			}
 		}
 		else
 		{
-			const auto img = std::make_unique<uint[]>(image_size);
-			uint* source_current = reinterpret_cast<uint*>(image.get());
-			uint* dest_current = img.get();
-			for (uint i = 0; i < image_size / nComponents; i++)
-			{
-				uint val = *source_current;
-				*dest_current = (val >> 24) | (val << 8); // set alpha (A8) as leftmost byte
-				source_current++;
-				dest_current++;
-			}
-			std::memcpy(data.get_ptr(), img.get(), image_size);
+			image_rgba_to_argb(data.get_ptr(), pixels, image_size / nComponents);
 		}
 	}
 	break;
@@ -316,6 +310,7 @@ error_code cellGifDecClose(PMainHandle mainHandle, PSubHandle subHandle)
 {
 	cellGifDec.warning("cellGifDecClose(mainHandle=*0x%x, subHandle=*0x%x)", mainHandle, subHandle);
 
+	image_decoder_discard(image_decoder_type::gif, subHandle.addr());
 	idm::remove<lv2_fs_object, lv2_file>(subHandle->fd);
 
 	vm::dealloc(subHandle.addr());
@@ -325,7 +320,9 @@ error_code cellGifDecClose(PMainHandle mainHandle, PSubHandle subHandle)
 
 error_code cellGifDecDestroy(PMainHandle mainHandle)
 {
-	UNIMPLEMENTED_FUNC(cellGifDec);
+	cellGifDec.todo("cellGifDecDestroy(mainHandle=*0x%x)", mainHandle);
+
+	image_decoder_discard_all(image_decoder_type::gif, mainHandle.addr());
 	return CELL_OK;
 }
 
@@ -3,11 +3,9 @@
 #include "Emu/IdManager.h"
 #include "Emu/Cell/PPUModule.h"
 
-// STB_IMAGE_IMPLEMENTATION is already defined in stb_image.cpp
-#include <stb_image.h>
-
 #include "Emu/Cell/lv2/sys_fs.h"
 #include "cellJpgDec.h"
+#include "image_decoder.h"
 
 #include "util/asm.hpp"
 
@@ -54,7 +52,9 @@ error_code cellJpgDecExtCreate(u32 mainHandle, u32 threadInParam, u32 threadOutP
 
 error_code cellJpgDecDestroy(u32 mainHandle)
 {
-	UNIMPLEMENTED_FUNC(cellJpgDec);
+	cellJpgDec.todo("cellJpgDecDestroy(mainHandle=0x%x)", mainHandle);
+
+	image_decoder_discard_all(image_decoder_type::jpg, mainHandle);
 	return CELL_OK;
 }
 
@@ -67,10 +67,14 @@ error_code cellJpgDecOpen(u32 mainHandle, vm::ptr<u32> subHandle, vm::ptr<CellJp
 	current_subHandle.fd = 0;
 	current_subHandle.src = *src;
 
+	// Decoding starts in the background as soon as the stream is available
+	std::vector<u8> stream;
+
 	switch (src->srcSelect)
 	{
 	case CELL_JPGDEC_BUFFER:
 		current_subHandle.fileSize = src->streamSize;
+		stream.assign(vm::_ptr<u8>(src->streamPtr), vm::_ptr<u8>(src->streamPtr) + src->streamSize);
 		break;
 
 	case CELL_JPGDEC_FILE:
@@ -81,6 +85,7 @@ error_code cellJpgDecOpen(u32 mainHandle, vm::ptr<u32> subHandle, vm::ptr<CellJp
 		if (!file_s) return CELL_JPGDEC_ERROR_OPEN_FILE;
 
 		current_subHandle.fileSize = file_s.size();
+		stream = file_s.to_vector<u8>();
 		current_subHandle.fd = idm::make<lv2_fs_object, lv2_file>(src->fileName.get_ptr(), std::move(file_s), 0, 0, real_path);
 		break;
 	}
@@ -90,6 +95,11 @@ error_code cellJpgDecOpen(u32 mainHandle, vm::ptr<u32> subHandle, vm::ptr<CellJp
 	// From now, every u32 subHandle argument is a pointer to a CellJpgDecSubHandle struct.
 	*subHandle = idm::make<CellJpgDecSubHandle>(current_subHandle);
 
+	if (!stream.empty())
+	{
+		image_decoder_prefetch(image_decoder_type::jpg, mainHandle, *subHandle, std::move(stream));
+	}
+
 	return CELL_OK;
 }
 
@@ -110,6 +120,7 @@ error_code cellJpgDecClose(u32 mainHandle, u32 subHandle)
 		return CELL_JPGDEC_ERROR_FATAL;
 	}
 
+	image_decoder_discard(image_decoder_type::jpg, subHandle);
 	idm::remove<lv2_fs_object, lv2_file>(subHandle_data->fd);
 	idm::remove<CellJpgDecSubHandle>(subHandle);
 
@@ -212,36 +223,41 @@ error_code cellJpgDecDecodeData(u32 mainHandle, u32 subHandle, vm::ptr<u8> data,
 	const u64& fileSize = subHandle_data->fileSize;
 	const CellJpgDecOutParam& current_outParam = subHandle_data->outParam;
 
-	//Copy the JPG file to a buffer
-	std::unique_ptr<u8[]> jpg(new u8[fileSize]);
+	std::shared_ptr<const decoded_image> image;
 
-	switch (subHandle_data->src.srcSelect)
+	// Use the result decoded in the background if the stream was prefetched on open
+	if (!image_decoder_take(image_decoder_type::jpg, subHandle, image))
 	{
-	case CELL_JPGDEC_BUFFER:
-		std::memcpy(jpg.get(), vm::base(subHandle_data->src.streamPtr), fileSize);
-		break;
+		//Copy the JPG file to a buffer
+		std::vector<u8> jpg(fileSize);
 
-	case CELL_JPGDEC_FILE:
-	{
-		auto file = idm::get<lv2_fs_object, lv2_file>(fd);
-		file->file.seek(0);
-		file->file.read(jpg.get(), fileSize);
-		break;
-	}
-	default: break; // TODO
-	}
+		switch (subHandle_data->src.srcSelect)
+		{
+		case CELL_JPGDEC_BUFFER:
+			std::memcpy(jpg.data(), vm::base(subHandle_data->src.streamPtr), fileSize);
+			break;
 
-	//Decode JPG file. (TODO: Is there any faster alternative? Can we do it without external libraries?)
-	int width, height, actual_components;
-	auto image = std::unique_ptr<unsigned char,decltype(&::free)>
-		(
-			stbi_load_from_memory(jpg.get(), ::narrow<int>(fileSize), &width, &height, &actual_components, 4),
-			&::free
-		);
+		case CELL_JPGDEC_FILE:
+		{
+			auto file = idm::get<lv2_fs_object, lv2_file>(fd);
+			file->file.seek(0);
+			file->file.read(jpg.data(), fileSize);
+			break;
+		}
+		default: break; // TODO
+		}
+
+		//Decode JPG file. (TODO: Is there any faster alternative? Can we do it without external libraries?)
+		image = image_decode(jpg);
+	}
 
 	if (!image)
 		return CELL_JPGDEC_ERROR_STREAM_FORMAT;
 
+	const int width = image->width;
+	const int height = image->height;
+	const u8* pixels = image->pixels.data();
+
 	const bool flip = current_outParam.outputMode == CELL_JPGDEC_BOTTOM_TO_TOP;
 	const int bytesPerLine = static_cast<int>(dataCtrlParam->outputBytesPerLine);
 	usz image_size = width * height;
@@ -260,12 +276,12 @@ error_code cellJpgDecDecodeData(u32 mainHandle, u32 subHandle, vm::ptr<u8> data,
 			{
 				const int dstOffset = i * bytesPerLine;
 				const int srcOffset = width * nComponents * (flip ? height - i - 1 : i);
-				memcpy(&data[dstOffset], &image.get()[srcOffset], linesize);
+				memcpy(&data[dstOffset], &pixels[srcOffset], linesize);
 			}
 		}
 		else
 		{
-			memcpy(data.get_ptr(), image.get(), image_size);
+			memcpy(data.get_ptr(), pixels, image_size);
 		}
 	}
 	break;
@@ -276,36 +292,17 @@ error_code cellJpgDecDecodeData(u32 mainHandle, u32 subHandle, vm::ptr<u8> data,
 		image_size *= nComponents;
 		if (bytesPerLine > width * nComponents || flip) //check if we need padding
 		{
-			//TODO: Find out if we can't do padding without an extra copy
 			const int linesize = std::min(bytesPerLine, width * nComponents);
-			const auto output = std::make_unique<char[]>(linesize);
 			for (int i = 0; i < height; i++)
 			{
 				const int dstOffset = i * bytesPerLine;
 				const int srcOffset = width * nComponents * (flip ? height - i - 1 : i);
-				for (int j = 0; j < linesize; j += nComponents)
-				{
-					output[j + 0] = image.get()[srcOffset + j + 3];
-					output[j + 1] = image.get()[srcOffset + j + 0];
-					output[j + 2] = image.get()[srcOffset + j + 1];
-					output[j + 3] = image.get()[srcOffset + j + 2];
-				}
-				std::memcpy(&data[dstOffset], output.get(), linesize);
+				image_rgba_to_argb(&data[dstOffset], &pixels[srcOffset], linesize / nComponents);
 			}
 		}
 		else
 		{
-			const auto img = std::make_unique<uint[]>(image_size);
-			uint* source_current = reinterpret_cast<uint*>(image.get());
-			uint* dest_current = img.get();
-			for (uint i = 0; i < image_size / nComponents; i++)
-			{
-				uint val = *source_current;
-				*dest_current = (val >> 24) | (val << 8); // set alpha (A8) as leftmost byte
-				source_current++;
-				dest_current++;
-			}
-			std::memcpy(data.get_ptr(), img.get(), image_size);
+			image_rgba_to_argb(data.get_ptr(), pixels, image_size / nComponents);
 		}
 	}
 	break;
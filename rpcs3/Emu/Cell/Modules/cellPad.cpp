@@ -4,6 +4,7 @@
 #include "Emu/Cell/PPUModule.h"
 #include "Emu/Cell/lv2/sys_process.h"
 #include "Emu/Io/pad_types.h"
+#include "Emu/Io/PadHandler.h"
 #include "Input/pad_thread.h"
 #include "Input/product_info.h"
 #include "cellPad.h"
@@ -388,6 +389,16 @@ void pad_get_data(u32 port_no, CellPadData* data)
 		data->len = CELL_PAD_LEN_NO_CHANGE;
 	}
 
+	// Measure the time between the oldest pending input change and its delivery to the game (kept pending until a change is delivered)
+	if (data->len > CELL_PAD_LEN_NO_CHANGE)
+	{
+		if (const u64 input_time = pad->m_input_timestamp.exchange(0))
+		{
+			const u64 now = PadHandlerBase::get_input_timestamp();
+			pad->m_latency.add_sample(now > input_time ? now - input_time : 0);
+		}
+	}
+
 	pad->m_buffer_cleared = false;
 
 	// only update parts of the output struct depending on the controller setting
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Emu/IdManager.h"
 #include "Emu/perf_meter.hpp"
+#include "Emu/system_config.h"
 #include "Emu/Cell/PPUModule.h"
 #include "Emu/Cell/lv2/sys_sync.h"
 #include "Emu/Cell/lv2/sys_ppu_thread.h"
@@ -141,12 +142,109 @@ struct vdec_cmd
 	CellVdecAuInfo au{};
 };
 
+// Recycles AVFrame structures and converted picture buffers of a decoder context
+struct vdec_frame_pool
+{
+	static constexpr usz max_pooled = 64;
+
+	std::mutex mutex;
+	std::vector<AVFrame*> frames;
+	std::vector<std::vector<u8>> buffers;
+
+	vdec_frame_pool() = default;
+	vdec_frame_pool(const vdec_frame_pool&) = delete;
+	vdec_frame_pool& operator=(const vdec_frame_pool&) = delete;
+
+	~vdec_frame_pool()
+	{
+		for (AVFrame* frame : frames)
+		{
+			av_frame_free(&frame);
+		}
+	}
+
+	AVFrame* get_frame()
+	{
+		{
+			std::lock_guard lock(mutex);
+
+			if (!frames.empty())
+			{
+				AVFrame* frame = frames.back();
+				frames.pop_back();
+				return frame;
+			}
+		}
+
+		return av_frame_alloc();
+	}
+
+	void put_frame(AVFrame* frame)
+	{
+		// Releases the references to the decoder's buffers, which are pooled by FFmpeg itself
+		av_frame_unref(frame);
+
+		{
+			std::lock_guard lock(mutex);
+
+			if (frames.size() < max_pooled)
+			{
+				frames.push_back(frame);
+				return;
+			}
+		}
+
+		av_frame_free(&frame);
+	}
+
+	std::vector<u8> get_buffer(usz size)
+	{
+		std::vector<u8> buffer;
+
+		{
+			std::lock_guard lock(mutex);
+
+			if (!buffers.empty())
+			{
+				buffer = std::move(buffers.back());
+				buffers.pop_back();
+			}
+		}
+
+		buffer.resize(size);
+		return buffer;
+	}
+
+	void put_buffer(std::vector<u8>&& buffer)
+	{
+		if (buffer.empty())
+		{
+			return;
+		}
+
+		std::lock_guard lock(mutex);
+
+		if (buffers.size() < max_pooled)
+		{
+			buffers.push_back(std::move(buffer));
+		}
+	}
+};
+
 struct vdec_frame
 {
 	struct frame_dtor
 	{
+		vdec_frame_pool* pool;
+
 		void operator()(AVFrame* data) const
 		{
+			if (pool)
+			{
+				pool->put_frame(data);
+				return;
+			}
+
 			av_frame_unref(data);
 			av_frame_free(&data);
 		}
@@ -163,12 +261,101 @@ struct vdec_frame
 	bool pic_item_received = false;
 	CellVdecPicAttr attr = CELL_VDEC_PICITEM_ATTR_NORMAL;
 
+	// Picture converted by the decoder thread ahead of cellVdecGetPicture, using the last format requested by the game
+	std::vector<u8> converted;
+	u64 converted_format = umax;
+
 	AVFrame* operator ->() const
 	{
 		return avf.get();
 	}
 };
 
+// Packs the parameters which affect the converted picture
+static u64 vdec_pack_picture_format(u32 format_type, u8 alpha)
+{
+	return u64{format_type} << 8 | alpha;
+}
+
+// Size of a picture converted to the given guest format
+static u32 vdec_get_picture_size(u32 format_type, int w, int h)
+{
+	switch (format_type)
+	{
+	case CELL_VDEC_PICFMT_ARGB32_ILV:
+	case CELL_VDEC_PICFMT_RGBA32_ILV: return w * h * 4;
+	case CELL_VDEC_PICFMT_UYVY422_ILV: return w * h * 2;
+	case CELL_VDEC_PICFMT_YUV420_PLANAR: return w * h * 3 / 2;
+	default: return 0;
+	}
+}
+
+static void vdec_convert_picture(SwsContext*& sws, const vdec_frame& frame, u32 handle, u32 format_type, u8 alpha, u8* out)
+{
+	const int w = frame->width;
+	const int h = frame->height;
+
+	AVPixelFormat out_f = AV_PIX_FMT_YUV420P;
+
+	std::unique_ptr<u8[]> alpha_plane;
+
+	switch (format_type)
+	{
+	case CELL_VDEC_PICFMT_ARGB32_ILV: out_f = AV_PIX_FMT_ARGB; alpha_plane.reset(new u8[w * h]); break;
+	case CELL_VDEC_PICFMT_RGBA32_ILV: out_f = AV_PIX_FMT_RGBA; alpha_plane.reset(new u8[w * h]); break;
+	case CELL_VDEC_PICFMT_UYVY422_ILV: out_f = AV_PIX_FMT_UYVY422; break;
+	case CELL_VDEC_PICFMT_YUV420_PLANAR: out_f = AV_PIX_FMT_YUV420P; break;
+	default:
+	{
+		fmt::throw_exception("cellVdecGetPictureExt: Unknown formatType (handle=0x%x, seq_id=%d, cmd_id=%d, type=%d)", handle, frame.seq_id, frame.cmd_id, format_type);
+	}
+	}
+
+	// TODO: color matrix
+
+	if (alpha_plane)
+	{
+		std::memset(alpha_plane.get(), alpha, w * h);
+	}
+
+	AVPixelFormat in_f = AV_PIX_FMT_YUV420P;
+
+	switch (frame->format)
+	{
+	case AV_PIX_FMT_YUVJ420P:
+		cellVdec.error("cellVdecGetPictureExt: experimental AVPixelFormat (handle=0x%x, seq_id=%d, cmd_id=%d, format=%d). This may cause suboptimal video quality.", handle, frame.seq_id, frame.cmd_id, frame->format);
+		[[fallthrough]];
+	case AV_PIX_FMT_YUV420P:
+		in_f = alpha_plane ? AV_PIX_FMT_YUVA420P : static_cast<AVPixelFormat>(frame->format);
+		break;
+	default:
+		fmt::throw_exception("cellVdecGetPictureExt: Unknown frame format (%d)", frame->format);
+	}
+
+	cellVdec.trace("cellVdecGetPictureExt: handle=0x%x, seq_id=%d, cmd_id=%d, w=%d, h=%d, frameFormat=%d, formatType=%d, in_f=%d, out_f=%d, alpha_plane=%d, alpha=%d", handle, frame.seq_id, frame.cmd_id, w, h, frame->format, format_type, +in_f, +out_f, !!alpha_plane, alpha);
+
+	sws = sws_getCachedContext(sws, w, h, in_f, w, h, out_f, SWS_POINT, nullptr, nullptr, nullptr);
+
+	u8* in_data[4] = { frame->data[0], frame->data[1], frame->data[2], alpha_plane.get() };
+	int in_line[4] = { frame->linesize[0], frame->linesize[1], frame->linesize[2], w * 1 };
+	u8* out_data[4] = { out };
+	int out_line[4] = { w * 4 }; // RGBA32 or ARGB32
+
+	if (!alpha_plane)
+	{
+		// YUV420P or UYVY422
+		out_data[1] = out_data[0] + w * h;
+		out_data[2] = out_data[0] + w * h * 5 / 4;
+
+		if (const int ret = av_image_fill_linesizes(out_line, out_f, w); ret < 0)
+		{
+			fmt::throw_exception("cellVdecGetPictureExt: av_image_fill_linesizes failed (handle=0x%x, seq_id=%d, cmd_id=%d, ret=0x%x): %s", handle, frame.seq_id, frame.cmd_id, ret, utils::av_error_to_string(ret));
+		}
+	}
+
+	sws_scale(sws, in_data, in_line, 0, h, out_data, out_line);
+}
+
 struct vdec_context final
 {
 	static const u32 id_base = 0xf0000000;
@@ -187,6 +374,21 @@ struct vdec_context final
 	const AVCodec* codec{};
 	AVCodecContext* ctx{};
 	SwsContext* sws{};
+	SwsContext* sws_async{}; // Used by the decoder thread for the asynchronous conversion
+
+	vdec_frame_pool frame_pool; // Must outlive all frames
+	atomic_t<u64> last_pic_format = umax; // Last picture format requested by the game (see vdec_pack_picture_format)
+	bool frame_threading = false;
+
+	// Parameters of the recently sent AUs, frames carry the AU number through the decoder (frame threading and reordering delay the output)
+	struct au_info
+	{
+		u64 userdata;
+		CellVdecPicAttr attr;
+	};
+
+	std::array<au_info, 64> au_infos{};
+	u64 au_sent = 0;
 
 	shared_mutex mutex; // Used for 'out' queue (TODO)
 
@@ -253,6 +455,20 @@ struct vdec_context final
 			fmt::throw_exception("avcodec_alloc_context3() failed (type=0x%x)", type);
 		}
 
+		// 0 lets FFmpeg pick the thread count, 1 keeps the decoder single-threaded
+		const s32 thread_count = g_cfg.core.vdec_threads;
+
+		if (thread_count != 1)
+		{
+			ctx->thread_count = thread_count;
+			ctx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+		}
+
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+		// Pass AVPacket::opaque to the decoded frame
+		ctx->flags |= AV_CODEC_FLAG_COPY_OPAQUE;
+#endif
+
 		AVDictionary* opts = nullptr;
 
 		std::lock_guard lock(g_mutex_avcodec_open2);
@@ -275,6 +491,11 @@ struct vdec_context final
 
 		av_dict_free(&opts);
 
+		// Frame threading delays the output by up to one frame per thread, so the decoder has to be drained at the end of a sequence
+		frame_threading = (ctx->active_thread_type & FF_THREAD_FRAME) != 0;
+
+		cellVdec.notice("Opened video decoder (type=0x%x, threads=%d, frame_threading=%d)", type, ctx->thread_count, frame_threading);
+
 		seq_state = sequence_state::dormant;
 	}
 
@@ -283,6 +504,226 @@ struct vdec_context final
 		avcodec_close(ctx);
 		avcodec_free_context(&ctx);
 		sws_freeContext(sws);
+		sws_freeContext(sws_async);
+	}
+
+	// Sets the AU number passed to the frames decoded from the packet
+	void set_au_tag(AVPacket& packet, u64 tag)
+	{
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+		packet.opaque = reinterpret_cast<void*>(static_cast<uptr>(tag));
+#else
+		static_cast<void>(packet);
+		ctx->reordered_opaque = tag;
+#endif
+	}
+
+	static u64 get_au_tag(const AVFrame* frame)
+	{
+#ifdef AV_CODEC_FLAG_COPY_OPAQUE
+		return reinterpret_cast<uptr>(frame->opaque);
+#else
+		return frame->reordered_opaque;
+#endif
+	}
+
+	// Receives all pending frames from the decoder
+	void receive_frames(const vdec_cmd& cmd, std::deque<vdec_frame>& decoded_frames)
+	{
+		while (!abort_decode && seq_id == cmd.seq_id)
+		{
+			// Keep receiving frames
+			vdec_frame frame;
+			frame.seq_id = cmd.seq_id;
+			frame.cmd_id = cmd.id;
+			frame.avf = std::unique_ptr<AVFrame, vdec_frame::frame_dtor>(frame_pool.get_frame(), vdec_frame::frame_dtor{&frame_pool});
+
+			if (!frame.avf)
+			{
+				fmt::throw_exception("av_frame_alloc() failed (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd.seq_id, cmd.id);
+			}
+
+			if (int ret = avcodec_receive_frame(ctx, frame.avf.get()); ret < 0)
+			{
+				if (ret == AVERROR(EAGAIN) || ret == AVERROR(EOF))
+				{
+					break;
+				}
+
+				fmt::throw_exception("AU decoding error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd.seq_id, cmd.id, ret, utils::av_error_to_string(ret));
+			}
+
+			if (frame->interlaced_frame)
+			{
+				// NPEB01838, NPUB31260
+				cellVdec.todo("Interlaced frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d, interlaced_frame=0x%x)", handle, cmd.seq_id, cmd.id, frame->interlaced_frame);
+			}
+
+			if (frame->repeat_pict)
+			{
+				fmt::throw_exception("Repeated frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d, repear_pict=0x%x)", handle, cmd.seq_id, cmd.id, frame->repeat_pict);
+			}
+
+			if (frame->pts != smin)
+			{
+				next_pts = frame->pts;
+			}
+
+			if (frame->pkt_dts != smin)
+			{
+				next_dts = frame->pkt_dts;
+			}
+
+			frame.pts = next_pts;
+			frame.dts = next_dts;
+
+			// Get the parameters of the AU the picture was decoded from (0: unknown)
+			if (const u64 tag = get_au_tag(frame.avf.get()); tag && tag <= au_sent && au_sent - tag < au_infos.size())
+			{
+				const au_info& info = au_infos[tag % au_infos.size()];
+				frame.userdata = info.userdata;
+				frame.attr = info.attr;
+			}
+
+			if (frc_set)
+			{
+				u64 amend = 0;
+
+				switch (frc_set)
+				{
+				case CELL_VDEC_FRC_24000DIV1001: amend = 1001 * 90000 / 24000; break;
+				case CELL_VDEC_FRC_24: amend = 90000 / 24; break;
+				case CELL_VDEC_FRC_25: amend = 90000 / 25; break;
+				case CELL_VDEC_FRC_30000DIV1001: amend = 1001 * 90000 / 30000; break;
+				case CELL_VDEC_FRC_30: amend = 90000 / 30; break;
+				case CELL_VDEC_FRC_50: amend = 90000 / 50; break;
+				case CELL_VDEC_FRC_60000DIV1001: amend = 1001 * 90000 / 60000; break;
+				case CELL_VDEC_FRC_60: amend = 90000 / 60; break;
+				default:
+				{
+					fmt::throw_exception("Invalid frame rate code set (handle=0x%x, seq_id=%d, cmd_id=%d, frc=0x%x)", handle, cmd.seq_id, cmd.id, frc_set);
+				}
+				}
+
+				next_pts += amend;
+				next_dts += amend;
+				frame.frc = frc_set;
+			}
+			else if (ctx->time_base.num == 0)
+			{
+				if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
+				{
+					cellVdec.error("time_base.num is 0 (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd.seq_id, cmd.id, ctx->time_base.num, ctx->time_base.den, ctx->ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
+					log_time_base = ctx->time_base;
+				}
+
+				// Hack
+				const u64 amend = u64{90000} / 30;
+				frame.frc = CELL_VDEC_FRC_30;
+				next_pts += amend;
+				next_dts += amend;
+			}
+			else
+			{
+				u64 amend = u64{90000} * ctx->time_base.num * ctx->ticks_per_frame / ctx->time_base.den;
+				const auto freq = 1. * ctx->time_base.den / ctx->time_base.num / ctx->ticks_per_frame;
+
+				if (std::abs(freq - 23.976) < 0.002)
+					frame.frc = CELL_VDEC_FRC_24000DIV1001;
+				else if (std::abs(freq - 24.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_24;
+				else if (std::abs(freq - 25.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_25;
+				else if (std::abs(freq - 29.970) < 0.002)
+					frame.frc = CELL_VDEC_FRC_30000DIV1001;
+				else if (std::abs(freq - 30.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_30;
+				else if (std::abs(freq - 50.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_50;
+				else if (std::abs(freq - 59.940) < 0.002)
+					frame.frc = CELL_VDEC_FRC_60000DIV1001;
+				else if (std::abs(freq - 60.000) < 0.001)
+					frame.frc = CELL_VDEC_FRC_60;
+				else
+				{
+					if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
+					{
+						// 1/1000 usually means that the time stamps are written in 1ms units and that the frame rate may vary.
+						cellVdec.error("Unsupported time_base (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd.seq_id, cmd.id, ctx->time_base.num, ctx->time_base.den, ctx->ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
+						log_time_base = ctx->time_base;
+					}
+
+					// Hack
+					amend = u64{90000} / 30;
+					frame.frc = CELL_VDEC_FRC_30;
+				}
+
+				next_pts += amend;
+				next_dts += amend;
+			}
+
+			cellVdec.trace("Got picture (handle=0x%x, seq_id=%d, cmd_id=%d, pts=0x%llx[0x%llx], dts=0x%llx[0x%llx])", handle, cmd.seq_id, cmd.id, frame.pts, frame->pts, frame.dts, frame->pkt_dts);
+
+			decoded_frames.push_back(std::move(frame));
+		}
+	}
+
+	// Moves decoded frames to the image queue and notifies the game about each picture
+	void output_frames(ppu_thread& ppu, u32 vid, const vdec_cmd& cmd, std::deque<vdec_frame>& decoded_frames)
+	{
+		while (!decoded_frames.empty() && seq_id == cmd.seq_id)
+		{
+			// Convert the picture before it becomes visible to the game, so that cellVdecGetPicture only has to copy it
+			if (const u64 format = last_pic_format; format != umax && g_cfg.core.vdec_async_conversion)
+			{
+				vdec_frame& frame = decoded_frames.front();
+				const u32 format_type = static_cast<u32>(format >> 8);
+
+				if (const u32 size = vdec_get_picture_size(format_type, frame->width, frame->height); size && frame.converted_format != format)
+				{
+					frame.converted = frame_pool.get_buffer(size);
+					vdec_convert_picture(sws_async, frame, handle, format_type, static_cast<u8>(format), frame.converted.data());
+					frame.converted_format = format;
+				}
+			}
+
+			// Wait until there is free space in the image queue.
+			// Do this after pushing the frame to the queue. That way the game can consume the frame and we can move on.
+			u32 elapsed = 0;
+			while (thread_ctrl::state() != thread_state::aborting && !abort_decode && seq_id == cmd.seq_id)
+			{
+				{
+					std::lock_guard lock{mutex};
+
+					if (out_queue.size() <= out_max)
+					{
+						break;
+					}
+				}
+				thread_ctrl::wait_for(1000);
+
+				if (elapsed++ >= 5000) // 5 seconds
+				{
+					cellVdec.error("Video au decode has been waiting for a consumer for 5 seconds. (handle=0x%x, seq_id=%d, cmd_id=%d, queue_size=%d)", handle, cmd.seq_id, cmd.id, out_queue.size());
+					elapsed = 0;
+				}
+			}
+
+			if (thread_ctrl::state() == thread_state::aborting || abort_decode || seq_id != cmd.seq_id)
+			{
+				break;
+			}
+
+			{
+				std::lock_guard lock{mutex};
+				out_queue.push_back(std::move(decoded_frames.front()));
+				decoded_frames.pop_front();
+			}
+
+			cellVdec.trace("Sending CELL_VDEC_MSG_TYPE_PICOUT (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd.seq_id, cmd.id);
+			cb_func(ppu, vid, CELL_VDEC_MSG_TYPE_PICOUT, CELL_OK, cb_arg);
+			lv2_obj::sleep(ppu);
+		}
 	}
 
 	void exec(ppu_thread& ppu, u32 vid)
@@ -348,6 +789,21 @@ struct vdec_context final
 			{
 				cellVdec.trace("End sequence... (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd->seq_id, cmd->id);
 
+				if (frame_threading && !abort_decode && seq_id == cmd->seq_id)
+				{
+					// Drain the pictures still held by the decoder threads
+					if (int ret = avcodec_send_packet(ctx, nullptr); ret < 0 && ret != AVERROR(EOF))
+					{
+						fmt::throw_exception("Decoder drain error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd->seq_id, cmd->id, ret, utils::av_error_to_string(ret));
+					}
+
+					std::deque<vdec_frame> decoded_frames;
+					receive_frames(*cmd, decoded_frames);
+					output_frames(ppu, vid, *cmd, decoded_frames);
+
+					avcodec_flush_buffers(ctx);
+				}
+
 				{
 					std::lock_guard lock{mutex};
 					seq_state = sequence_state::dormant;
@@ -399,141 +855,15 @@ struct vdec_context final
 				{
 					cellVdec.trace("AU decoding: handle=0x%x, seq_id=%d, cmd_id=%d, size=0x%x, pts=0x%llx, dts=0x%llx, userdata=0x%llx", handle, cmd->seq_id, cmd->id, au_size, au_pts, au_dts, au_usrd);
 
+					au_infos[++au_sent % au_infos.size()] = {au_usrd, attr};
+					set_au_tag(packet, au_sent);
+
 					if (int ret = avcodec_send_packet(ctx, &packet); ret < 0)
 					{
 						fmt::throw_exception("AU queuing error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd->seq_id, cmd->id, ret, utils::av_error_to_string(ret));
 					}
 
-					while (!abort_decode && seq_id == cmd->seq_id)
-					{
-						// Keep receiving frames
-						vdec_frame frame;
-						frame.seq_id = cmd->seq_id;
-						frame.cmd_id = cmd->id;
-						frame.avf.reset(av_frame_alloc());
-
-						if (!frame.avf)
-						{
-							fmt::throw_exception("av_frame_alloc() failed (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd->seq_id, cmd->id);
-						}
-
-						if (int ret = avcodec_receive_frame(ctx, frame.avf.get()); ret < 0)
-						{
-							if (ret == AVERROR(EAGAIN) || ret == AVERROR(EOF))
-							{
-								break;
-							}
-
-							fmt::throw_exception("AU decoding error (handle=0x%x, seq_id=%d, cmd_id=%d, error=0x%x): %s", handle, cmd->seq_id, cmd->id, ret, utils::av_error_to_string(ret));
-						}
-
-						if (frame->interlaced_frame)
-						{
-							// NPEB01838, NPUB31260
-							cellVdec.todo("Interlaced frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d, interlaced_frame=0x%x)", handle, cmd->seq_id, cmd->id, frame->interlaced_frame);
-						}
-
-						if (frame->repeat_pict)
-						{
-							fmt::throw_exception("Repeated frames not supported (handle=0x%x, seq_id=%d, cmd_id=%d, repear_pict=0x%x)", handle, cmd->seq_id, cmd->id, frame->repeat_pict);
-						}
-
-						if (frame->pts != smin)
-						{
-							next_pts = frame->pts;
-						}
-
-						if (frame->pkt_dts != smin)
-						{
-							next_dts = frame->pkt_dts;
-						}
-
-						frame.pts = next_pts;
-						frame.dts = next_dts;
-						frame.userdata = au_usrd;
-						frame.attr = attr;
-
-						if (frc_set)
-						{
-							u64 amend = 0;
-
-							switch (frc_set)
-							{
-							case CELL_VDEC_FRC_24000DIV1001: amend = 1001 * 90000 / 24000; break;
-							case CELL_VDEC_FRC_24: amend = 90000 / 24; break;
-							case CELL_VDEC_FRC_25: amend = 90000 / 25; break;
-							case CELL_VDEC_FRC_30000DIV1001: amend = 1001 * 90000 / 30000; break;
-							case CELL_VDEC_FRC_30: amend = 90000 / 30; break;
-							case CELL_VDEC_FRC_50: amend = 90000 / 50; break;
-							case CELL_VDEC_FRC_60000DIV1001: amend = 1001 * 90000 / 60000; break;
-							case CELL_VDEC_FRC_60: amend = 90000 / 60; break;
-							default:
-							{
-								fmt::throw_exception("Invalid frame rate code set (handle=0x%x, seq_id=%d, cmd_id=%d, frc=0x%x)", handle, cmd->seq_id, cmd->id, frc_set);
-							}
-							}
-
-							next_pts += amend;
-							next_dts += amend;
-							frame.frc = frc_set;
-						}
-						else if (ctx->time_base.num == 0)
-						{
-							if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
-							{
-								cellVdec.error("time_base.num is 0 (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd->seq_id, cmd->id, ctx->time_base.num, ctx->time_base.den, ctx->ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
-								log_time_base = ctx->time_base;
-							}
-
-							// Hack
-							const u64 amend = u64{90000} / 30;
-							frame.frc = CELL_VDEC_FRC_30;
-							next_pts += amend;
-							next_dts += amend;
-						}
-						else
-						{
-							u64 amend = u64{90000} * ctx->time_base.num * ctx->ticks_per_frame / ctx->time_base.den;
-							const auto freq = 1. * ctx->time_base.den / ctx->time_base.num / ctx->ticks_per_frame;
-
-							if (std::abs(freq - 23.976) < 0.002)
-								frame.frc = CELL_VDEC_FRC_24000DIV1001;
-							else if (std::abs(freq - 24.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_24;
-							else if (std::abs(freq - 25.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_25;
-							else if (std::abs(freq - 29.970) < 0.002)
-								frame.frc = CELL_VDEC_FRC_30000DIV1001;
-							else if (std::abs(freq - 30.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_30;
-							else if (std::abs(freq - 50.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_50;
-							else if (std::abs(freq - 59.940) < 0.002)
-								frame.frc = CELL_VDEC_FRC_60000DIV1001;
-							else if (std::abs(freq - 60.000) < 0.001)
-								frame.frc = CELL_VDEC_FRC_60;
-							else
-							{
-								if (log_time_base.den != ctx->time_base.den || log_time_base.num != ctx->time_base.num)
-								{
-									// 1/1000 usually means that the time stamps are written in 1ms units and that the frame rate may vary.
-									cellVdec.error("Unsupported time_base (handle=0x%x, seq_id=%d, cmd_id=%d, %d/%d, tpf=%d framerate=%d/%d)", handle, cmd->seq_id, cmd->id, ctx->time_base.num, ctx->time_base.den, ctx->ticks_per_frame, ctx->framerate.num, ctx->framerate.den);
-									log_time_base = ctx->time_base;
-								}
-
-								// Hack
-								amend = u64{90000} / 30;
-								frame.frc = CELL_VDEC_FRC_30;
-							}
-
-							next_pts += amend;
-							next_dts += amend;
-						}
-
-						cellVdec.trace("Got picture (handle=0x%x, seq_id=%d, cmd_id=%d, pts=0x%llx[0x%llx], dts=0x%llx[0x%llx])", handle, cmd->seq_id, cmd->id, frame.pts, frame->pts, frame.dts, frame->pkt_dts);
-
-						decoded_frames.push_back(std::move(frame));
-					}
+					receive_frames(*cmd, decoded_frames);
 				}
 
 				if (thread_ctrl::state() != thread_state::aborting)
@@ -548,45 +878,7 @@ struct vdec_context final
 						--au_count;
 					}
 
-					while (!decoded_frames.empty() && seq_id == cmd->seq_id)
-					{
-						// Wait until there is free space in the image queue.
-						// Do this after pushing the frame to the queue. That way the game can consume the frame and we can move on.
-						u32 elapsed = 0;
-						while (thread_ctrl::state() != thread_state::aborting && !abort_decode && seq_id == cmd->seq_id)
-						{
-							{
-								std::lock_guard lock{mutex};
-
-								if (out_queue.size() <= out_max)
-								{
-									break;
-								}
-							}
-							thread_ctrl::wait_for(1000);
-
-							if (elapsed++ >= 5000) // 5 seconds
-							{
-								cellVdec.error("Video au decode has been waiting for a consumer for 5 seconds. (handle=0x%x, seq_id=%d, cmd_id=%d, queue_size=%d)", handle, cmd->seq_id, cmd->id, out_queue.size());
-								elapsed = 0;
-							}
-						}
-
-						if (thread_ctrl::state() == thread_state::aborting || abort_decode || seq_id != cmd->seq_id)
-						{
-							break;
-						}
-
-						{
-							std::lock_guard lock{mutex};
-							out_queue.push_back(std::move(decoded_frames.front()));
-							decoded_frames.pop_front();
-						}
-
-						cellVdec.trace("Sending CELL_VDEC_MSG_TYPE_PICOUT (handle=0x%x, seq_id=%d, cmd_id=%d)", handle, cmd->seq_id, cmd->id);
-						cb_func(ppu, vid, CELL_VDEC_MSG_TYPE_PICOUT, CELL_OK, cb_arg);
-						lv2_obj::sleep(ppu);
-					}
+					output_frames(ppu, vid, *cmd, decoded_frames);
 				}
 
 				if (abort_decode || seq_id != cmd->seq_id)
@@ -1241,74 +1533,26 @@ error_code cellVdecGetPictureExt(u32 handle, vm::cptr<CellVdecPicFormat2> format
 
 	if (sequence_id != frame.seq_id)
 	{
+		vdec->frame_pool.put_buffer(std::move(frame.converted));
 		return { CELL_VDEC_ERROR_EMPTY, "sequence_id=%d, seq_id=%d", sequence_id, frame.seq_id };
 	}
 
 	if (outBuff)
 	{
-		const int w = frame->width;
-		const int h = frame->height;
+		const u64 pic_format = vdec_pack_picture_format(format->formatType, format->alpha);
 
-		AVPixelFormat out_f = AV_PIX_FMT_YUV420P;
+		// Remember the format for the asynchronous conversion of the next pictures
+		vdec->last_pic_format = pic_format;
 
-		std::unique_ptr<u8[]> alpha_plane;
-
-		switch (const u32 type = format->formatType)
+		if (frame.converted_format == pic_format)
 		{
-		case CELL_VDEC_PICFMT_ARGB32_ILV: out_f = AV_PIX_FMT_ARGB; alpha_plane.reset(new u8[w * h]); break;
-		case CELL_VDEC_PICFMT_RGBA32_ILV: out_f = AV_PIX_FMT_RGBA; alpha_plane.reset(new u8[w * h]); break;
-		case CELL_VDEC_PICFMT_UYVY422_ILV: out_f = AV_PIX_FMT_UYVY422; break;
-		case CELL_VDEC_PICFMT_YUV420_PLANAR: out_f = AV_PIX_FMT_YUV420P; break;
-		default:
-		{
-			fmt::throw_exception("cellVdecGetPictureExt: Unknown formatType (handle=0x%x, seq_id=%d, cmd_id=%d, type=%d)", handle, frame.seq_id, frame.cmd_id, type);
-		}
+			std::memcpy(outBuff.get_ptr(), frame.converted.data(), frame.converted.size());
 		}
-
-		// TODO: color matrix
-
-		if (alpha_plane)
+		else
 		{
-			std::memset(alpha_plane.get(), format->alpha, w * h);
+			vdec_convert_picture(vdec->sws, frame, handle, format->formatType, format->alpha, outBuff.get_ptr());
 		}
 
-		AVPixelFormat in_f = AV_PIX_FMT_YUV420P;
-
-		switch (frame->format)
-		{
-		case AV_PIX_FMT_YUVJ420P:
-			cellVdec.error("cellVdecGetPictureExt: experimental AVPixelFormat (handle=0x%x, seq_id=%d, cmd_id=%d, format=%d). This may cause suboptimal video quality.", handle, frame.seq_id, frame.cmd_id, frame->format);
-			[[fallthrough]];
-		case AV_PIX_FMT_YUV420P:
-			in_f = alpha_plane ? AV_PIX_FMT_YUVA420P : static_cast<AVPixelFormat>(frame->format);
-			break;
-		default:
-			fmt::throw_exception("cellVdecGetPictureExt: Unknown frame format (%d)", frame->format);
-		}
-
-		cellVdec.trace("cellVdecGetPictureExt: handle=0x%x, seq_id=%d, cmd_id=%d, w=%d, h=%d, frameFormat=%d, formatType=%d, in_f=%d, out_f=%d, alpha_plane=%d, alpha=%d, colorMatrixType=%d", handle, frame.seq_id, frame.cmd_id, w, h, frame->format, format->formatType, +in_f, +out_f, !!alpha_plane, format->alpha, format->colorMatrixType);
-
-		vdec->sws = sws_getCachedContext(vdec->sws, w, h, in_f, w, h, out_f, SWS_POINT, nullptr, nullptr, nullptr);
-
-		u8* in_data[4] = { frame->data[0], frame->data[1], frame->data[2], alpha_plane.get() };
-		int in_line[4] = { frame->linesize[0], frame->linesize[1], frame->linesize[2], w * 1 };
-		u8* out_data[4] = { outBuff.get_ptr() };
-		int out_line[4] = { w * 4 }; // RGBA32 or ARGB32
-
-		if (!alpha_plane)
-		{
-			// YUV420P or UYVY422
-			out_data[1] = out_data[0] + w * h;
-			out_data[2] = out_data[0] + w * h * 5 / 4;
-
-			if (const int ret = av_image_fill_linesizes(out_line, out_f, w); ret < 0)
-			{
-				fmt::throw_exception("cellVdecGetPictureExt: av_image_fill_linesizes failed (handle=0x%x, seq_id=%d, cmd_id=%d, ret=0x%x): %s", handle, frame.seq_id, frame.cmd_id, ret, utils::av_error_to_string(ret));
-			}
-		}
-
-		sws_scale(vdec->sws, in_data, in_line, 0, h, out_data, out_line);
-
 		//const u32 buf_size = utils::align(av_image_get_buffer_size(vdec->ctx->pix_fmt, vdec->ctx->width, vdec->ctx->height, 1), 128);
 
 		//// TODO: zero padding bytes
@@ -1320,6 +1564,9 @@ error_code cellVdecGetPictureExt(u32 handle, vm::cptr<CellVdecPicFormat2> format
 		//}
 	}
 
+	// Return the converted picture to the pool, also when the game only skips the picture (null outBuff)
+	vdec->frame_pool.put_buffer(std::move(frame.converted));
+
 	return CELL_OK;
 }
 
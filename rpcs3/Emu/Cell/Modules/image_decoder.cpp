@@ -0,0 +1,278 @@
+#include "stdafx.h"
+#include "image_decoder.h"
+#include "Emu/IdManager.h"
+#include "Utilities/mutex.h"
+#include "Utilities/Thread.h"
+#include "util/sysinfo.hpp"
+
+// STB_IMAGE_IMPLEMENTATION is already defined in stb_image.cpp
+#include <stb_image.h>
+
+#include "xxhash.h"
+
+#include <bit>
+#include <list>
+#include <unordered_map>
+
+LOG_CHANNEL(img_log, "IMG");
+
+namespace
+{
+	struct decode_job
+	{
+		u32 main_handle = 0; // Decoder instance which opened the stream
+		std::vector<u8> stream;
+		atomic_t<u32> state = 0; // 0: queued, 1: decoding, 2: finished or cancelled
+		std::shared_ptr<const decoded_image> result;
+
+		// Decode the stream unless another thread has already started
+		void run()
+		{
+			if (state.compare_and_swap_test(0, 1))
+			{
+				result = image_decode(stream);
+				stream = {};
+				state.release(2);
+				state.notify_all();
+			}
+		}
+
+		std::shared_ptr<const decoded_image> get()
+		{
+			run();
+
+			for (u32 value = state; value != 2; value = state)
+			{
+				state.wait(value);
+			}
+
+			return result;
+		}
+	};
+}
+
+// Worker threads shared by the image decoders and the decoded image cache
+struct image_decoder_pool
+{
+	struct worker
+	{
+		lf_queue<std::shared_ptr<decode_job>> queue;
+
+		void operator()()
+		{
+			while (thread_ctrl::state() != thread_state::aborting)
+			{
+				for (auto&& job : queue.pop_all())
+				{
+					job->run();
+				}
+
+				thread_ctrl::wait_on(queue, nullptr);
+			}
+		}
+	};
+
+	static constexpr u32 max_workers = 4;
+	static constexpr usz max_cache_size = 64 * 1024 * 1024;
+
+	shared_mutex mutex;
+	bool closed = false;
+	u32 next = 0;
+	std::unique_ptr<named_thread_group<worker>> workers;
+	std::unordered_map<u64, std::shared_ptr<decode_job>> jobs; // Prefetched streams by decoder type and handle
+
+	// Decoded images by content hash, most recently used first
+	shared_mutex cache_mutex;
+	std::list<std::pair<u64, std::shared_ptr<const decoded_image>>> cache;
+	std::unordered_map<u64, decltype(cache)::iterator> cache_map;
+	usz cache_size = 0;
+
+	atomic_t<u64> hits = 0;
+	atomic_t<u64> misses = 0;
+
+	~image_decoder_pool()
+	{
+		{
+			std::lock_guard lock(mutex);
+			closed = true;
+		}
+
+		// Threads waiting for a queued job decode it themselves
+		workers.reset();
+
+		if (hits || misses)
+		{
+			img_log.notice("Decoded image cache: %u hits, %u misses", hits.load(), misses.load());
+		}
+	}
+
+	static u64 make_key(image_decoder_type type, u32 handle)
+	{
+		return u64{static_cast<u32>(type)} << 32 | handle;
+	}
+};
+
+std::shared_ptr<const decoded_image> image_decode(const std::vector<u8>& stream)
+{
+	const auto pool = g_fxo->try_get<image_decoder_pool>();
+	const u64 hash = XXH64(stream.data(), stream.size(), stream.size());
+
+	if (pool)
+	{
+		std::lock_guard lock(pool->cache_mutex);
+
+		if (const auto found = pool->cache_map.find(hash); found != pool->cache_map.end())
+		{
+			pool->cache.splice(pool->cache.begin(), pool->cache, found->second);
+			pool->hits++;
+			return found->second->second;
+		}
+
+		pool->misses++;
+	}
+
+	int width, height, actual_components;
+	const auto image = std::unique_ptr<unsigned char, decltype(&::free)>
+		(
+			stbi_load_from_memory(stream.data(), ::narrow<int>(stream.size()), &width, &height, &actual_components, 4),
+			&::free
+		);
+
+	if (!image)
+	{
+		return nullptr;
+	}
+
+	auto result = std::make_shared<decoded_image>();
+	result->width = width;
+	result->height = height;
+	result->components = actual_components;
+	result->pixels.assign(image.get(), image.get() + usz(width) * height * 4);
+
+	if (!pool || result->pixels.size() > image_decoder_pool::max_cache_size / 4)
+	{
+		return result;
+	}
+
+	std::lock_guard lock(pool->cache_mutex);
+
+	if (pool->cache_map.contains(hash))
+	{
+		return result;
+	}
+
+	pool->cache.emplace_front(hash, result);
+	pool->cache_map.emplace(hash, pool->cache.begin());
+	pool->cache_size += result->pixels.size();
+
+	while (pool->cache_size > image_decoder_pool::max_cache_size)
+	{
+		// Evict the least recently used images
+		pool->cache_size -= pool->cache.back().second->pixels.size();
+		pool->cache_map.erase(pool->cache.back().first);
+		pool->cache.pop_back();
+	}
+
+	return result;
+}
+
+void image_decoder_prefetch(image_decoder_type type, u32 main_handle, u32 handle, std::vector<u8>&& stream)
+{
+	auto& pool = g_fxo->get<image_decoder_pool>();
+
+	const auto job = std::make_shared<decode_job>();
+	job->main_handle = main_handle;
+	job->stream = std::move(stream);
+
+	std::lock_guard lock(pool.mutex);
+
+	if (pool.closed)
+	{
+		return;
+	}
+
+	if (!pool.workers)
+	{
+		pool.workers = std::make_unique<named_thread_group<image_decoder_pool::worker>>("Image Decoder ", std::clamp<u32>(utils::get_thread_count() / 2, 1, image_decoder_pool::max_workers));
+	}
+
+	pool.jobs[image_decoder_pool::make_key(type, handle)] = job;
+	(pool.workers->begin() + pool.next++ % pool.workers->size())->queue.push(job);
+}
+
+bool image_decoder_take(image_decoder_type type, u32 handle, std::shared_ptr<const decoded_image>& result)
+{
+	std::shared_ptr<decode_job> job;
+
+	if (const auto pool = g_fxo->try_get<image_decoder_pool>())
+	{
+		std::lock_guard lock(pool->mutex);
+
+		if (const auto found = pool->jobs.find(image_decoder_pool::make_key(type, handle)); found != pool->jobs.end())
+		{
+			job = std::move(found->second);
+			pool->jobs.erase(found);
+		}
+	}
+
+	if (!job)
+	{
+		return false;
+	}
+
+	result = job->get();
+	return true;
+}
+
+void image_decoder_discard(image_decoder_type type, u32 handle)
+{
+	if (const auto pool = g_fxo->try_get<image_decoder_pool>())
+	{
+		std::lock_guard lock(pool->mutex);
+
+		if (const auto found = pool->jobs.find(image_decoder_pool::make_key(type, handle)); found != pool->jobs.end())
+		{
+			// Cancel if not started yet
+			found->second->state.compare_and_swap_test(0, 2);
+			pool->jobs.erase(found);
+		}
+	}
+}
+
+void image_decoder_discard_all(image_decoder_type type, u32 main_handle)
+{
+	if (const auto pool = g_fxo->try_get<image_decoder_pool>())
+	{
+		std::lock_guard lock(pool->mutex);
+
+		for (auto it = pool->jobs.begin(); it != pool->jobs.end();)
+		{
+			if (it->first >> 32 == static_cast<u32>(type) && it->second->main_handle == main_handle)
+			{
+				// Cancel if not started yet, a running decode finishes on its worker and is freed there
+				if (it->second->state.compare_and_swap_test(0, 2))
+				{
+					it->second->stream = {};
+				}
+
+				it = pool->jobs.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+}
+
+void image_rgba_to_argb(u8* dst, const u8* src, usz pixels)
+{
+	// Simple enough to be vectorized by the compiler
+	for (usz i = 0; i < pixels; i++)
+	{
+		u32 value;
+		std::memcpy(&value, src + i * 4, 4);
+		value = std::rotl(value, 8); // Set alpha (A8) as the first byte
+		std::memcpy(dst + i * 4, &value, 4);
+	}
+}
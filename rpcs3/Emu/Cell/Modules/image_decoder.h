@@ -0,0 +1,39 @@
+#pragma once
+
+#include "util/types.hpp"
+
+#include <memory>
+#include <vector>
+
+// Image decoded to RGBA by stb_image
+struct decoded_image
+{
+	s32 width = 0;
+	s32 height = 0;
+	s32 components = 0; // Number of components in the stream
+	std::vector<u8> pixels;
+};
+
+enum class image_decoder_type : u32
+{
+	jpg,
+	gif,
+};
+
+// Decode the stream on the calling thread (results are cached by content), nullptr on failure
+std::shared_ptr<const decoded_image> image_decode(const std::vector<u8>& stream);
+
+// Start decoding the stream of a sub handle opened by main_handle on a worker thread
+void image_decoder_prefetch(image_decoder_type type, u32 main_handle, u32 handle, std::vector<u8>&& stream);
+
+// Collect the prefetched result (decoding it on the calling thread if no worker has started yet), false if the stream wasn't prefetched
+bool image_decoder_take(image_decoder_type type, u32 handle, std::shared_ptr<const decoded_image>& result);
+
+// Drop the prefetched result of a closed sub handle
+void image_decoder_discard(image_decoder_type type, u32 handle);
+
+// Drop the prefetched results of all sub handles left open by a destroyed main handle
+void image_decoder_discard_all(image_decoder_type type, u32 main_handle);
+
+// Convert RGBA pixels to ARGB (dst and src may be equal)
+void image_rgba_to_argb(u8* dst, const u8* src, usz pixels);
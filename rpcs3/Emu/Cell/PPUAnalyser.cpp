@@ -4,6 +4,11 @@
 #include "PPUOpcodes.h"
 #include "PPUModule.h"
 #include "Emu/system_config.h"
+#include "Emu/IdManager.h"
+#include "Emu/Memory/vm.h"
+#include "Utilities/mutex.h"
+#include "util/serialization.hpp"
+#include "xxhash.h"
 
 #include <unordered_set>
 #include "util/yaml.hpp"
@@ -25,6 +30,7 @@ void fmt_class_string<ppu_attr>::format(std::string& out, u64 arg)
 		case ppu_attr::no_return: return "no_return";
 		case ppu_attr::no_size: return "no_size";
 		case ppu_attr::has_mfvscr: return "has_mfvscr";
+		case ppu_attr::indirect_calls: return "indirect_calls";
 		case ppu_attr::__bitset_enum_max: break;
 		}
 
@@ -532,6 +538,253 @@ namespace ppu_patterns
 	};
 }
 
+// Persistent analyser results of the loaded executables and libraries, shared by all titles
+class ppu_analysis_cache
+{
+	struct record
+	{
+		u64 key;
+		u64 checksum;
+		u32 size;
+		u32 reserved;
+	};
+
+	fs::file m_file;
+	bool m_opened = false;
+
+	shared_mutex m_mutex;
+
+	// Module key -> offset and size of the serialized functions
+	std::unordered_map<u64, std::pair<u64, u32>> m_index;
+
+	// Recreate the file when it grows past this size
+	static constexpr u64 max_size = 512 * 1024 * 1024;
+
+	void open()
+	{
+		if (std::exchange(m_opened, true))
+		{
+			return;
+		}
+
+		const std::string loc = fs::get_cache_dir() + "cache/ppu-analysis.dat";
+
+		if (!fs::create_path(fs::get_parent_dir(loc)) || !m_file.open(loc, fs::read + fs::write + fs::create))
+		{
+			ppu_log.error("Failed to open PPU analysis cache at: %s (%s)", loc, fs::g_tls_error);
+			return;
+		}
+
+		u32 file_version = 0;
+
+		if (!m_file.read(file_version) || file_version != version || m_file.size() > max_size)
+		{
+			// Empty, written by another version of the analyser or too large
+			m_file.trunc(0);
+			m_file.seek(0);
+			m_file.write(version);
+		}
+
+		const u64 file_size = m_file.size();
+
+		while (true)
+		{
+			const u64 pos = m_file.pos();
+
+			record header{};
+
+			if (!m_file.read(header) || file_size - m_file.pos() < header.size)
+			{
+				// Drop the incomplete record at the end, if any
+				m_file.trunc(pos);
+				break;
+			}
+
+			m_index.try_emplace(header.key, pos, header.size);
+			m_file.seek(header.size, fs::seek_cur);
+		}
+
+		ppu_log.notice("PPU analysis cache: %u modules indexed.", m_index.size());
+	}
+
+public:
+	// Must be incremented whenever the analyser output or its serialization changes
+	static constexpr u32 version = 1;
+
+	bool load(u64 key, std::vector<u8>& out)
+	{
+		std::lock_guard lock(m_mutex);
+
+		open();
+
+		const auto found = m_index.find(key);
+
+		if (found == m_index.end())
+		{
+			return false;
+		}
+
+		record header{};
+		out.resize(found->second.second);
+		m_file.seek(found->second.first);
+
+		if (!m_file.read(header) || header.key != key || m_file.read(out.data(), out.size()) != out.size() || XXH64(out.data(), out.size(), 0) != header.checksum)
+		{
+			ppu_log.error("PPU analysis cache: corrupted record 0x%016x", key);
+			m_index.erase(found);
+			return false;
+		}
+
+		return true;
+	}
+
+	void store(u64 key, const std::vector<u8>& data)
+	{
+		std::lock_guard lock(m_mutex);
+
+		open();
+
+		if (!m_file || m_index.contains(key))
+		{
+			return;
+		}
+
+		const record header{key, XXH64(data.data(), data.size(), 0), ::size32(data), 0};
+
+		const fs::iovec_clone gather[2]
+		{
+			{&header, sizeof(header)},
+			{data.data(), data.size()}
+		};
+
+		const u64 pos = m_file.seek(0, fs::seek_end);
+
+		if (m_file.write_gather(gather, 2) == sizeof(header) + data.size())
+		{
+			m_index.try_emplace(key, pos, ::size32(data));
+		}
+	}
+};
+
+static bool serialize_functions(utils::serial& ar, std::vector<ppu_function>& funcs)
+{
+	usz count = funcs.size();
+
+	if (ar.is_writing())
+	{
+		ar.serialize_vle(count);
+	}
+	else if (!ar.deserialize_vle(count) || count > ar.data.size())
+	{
+		return false;
+	}
+	else
+	{
+		funcs.resize(count);
+	}
+
+	for (ppu_function& func : funcs)
+	{
+		u32 attr = static_cast<u32>(func.attr);
+		ar(func.addr, func.toc, func.size, attr, func.stack_frame, func.trampoline);
+
+		usz blocks = func.blocks.size();
+
+		if (ar.is_writing())
+		{
+			ar.serialize_vle(blocks);
+
+			for (auto [addr, size] : func.blocks)
+			{
+				ar(addr, size);
+			}
+		}
+		else
+		{
+			for (u32 i = 0; i < bs_t<ppu_attr>::bitsize; i++)
+			{
+				if (attr & (1u << i))
+				{
+					func.attr += static_cast<ppu_attr>(i);
+				}
+			}
+
+			if (!ar.deserialize_vle(blocks) || blocks > ar.data.size())
+			{
+				return false;
+			}
+
+			for (usz i = 0; i < blocks; i++)
+			{
+				u32 addr = 0, size = 0;
+				ar(addr, size);
+				func.blocks.emplace(addr, size);
+			}
+		}
+
+		ar(func.calls, func.callers, func.name);
+
+		if (!ar.is_valid())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ppu_module::analyse_cached(u32 lib_toc, u32 entry, u32 end, const std::basic_string<u32>& applied)
+{
+	// The key covers the analyser arguments, the module layout and the loaded (relocated and patched) segment contents
+	utils::serial ar;
+	ar(lib_toc, entry, end, const_cast<std::basic_string<u32>&>(applied));
+
+	for (auto* list : {&segs, &secs})
+	{
+		for (ppu_segment& seg : *list)
+		{
+			ar(seg.addr, seg.size, seg.type, seg.flags, seg.filesz);
+		}
+	}
+
+	for (ppu_reloc& rel : relocs)
+	{
+		ar(rel.addr, rel.type, rel.data);
+	}
+
+	u64 key = XXH64(ar.data.data(), ar.data.size(), 0);
+
+	for (const ppu_segment& seg : segs)
+	{
+		if (seg.size && vm::check_addr(seg.addr, vm::page_readable, seg.size))
+		{
+			key = XXH64(vm::base(seg.addr), seg.size, key);
+		}
+	}
+
+	auto& cache = g_fxo->get<ppu_analysis_cache>();
+
+	if (std::vector<u8> data; funcs.empty() && cache.load(key, data))
+	{
+		ar.set_reading_state(std::move(data));
+
+		if (serialize_functions(ar, funcs))
+		{
+			ppu_log.notice("PPU analysis cache: restored %u functions of %s", funcs.size(), path);
+			return;
+		}
+
+		ppu_log.error("PPU analysis cache: invalid record 0x%016x", key);
+		funcs.clear();
+	}
+
+	analyse(lib_toc, entry, end, applied);
+
+	ar.clear();
+	serialize_functions(ar, funcs);
+	cache.store(key, ar.data);
+}
+
 void ppu_module::analyse(u32 lib_toc, u32 entry, const u32 sec_end, const std::basic_string<u32>& applied)
 {
 	// Assume first segment is executable
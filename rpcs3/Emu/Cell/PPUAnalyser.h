@@ -17,6 +17,7 @@ enum class ppu_attr : u32
 	no_return,
 	no_size,
 	has_mfvscr,
+	indirect_calls, // Calls to functions of other module parts go through the executable table (they may be linked later)
 
 	__bitset_enum_max
 };
@@ -102,6 +103,10 @@ struct ppu_module
 	}
 
 	void analyse(u32 lib_toc, u32 entry, u32 end, const std::basic_string<u32>& applied);
+
+	// Restore the functions from the persistent analysis cache if the loaded module is known, otherwise analyse and store them
+	void analyse_cached(u32 lib_toc, u32 entry, u32 end, const std::basic_string<u32>& applied);
+
 	void validate(u32 reloc);
 };
 
@@ -1401,7 +1401,7 @@ std::shared_ptr<lv2_prx> ppu_load_prx(const ppu_prx_object& elf, const std::stri
 		ppu_check_patch_spu_images(seg);
 	}
 
-	prx->analyse(toc, 0, end, applied);
+	prx->analyse_cached(toc, 0, end, applied);
 
 	try_spawn_ppu_if_exclusive_program(*prx);
 
@@ -1898,7 +1898,7 @@ bool ppu_load_exec(const ppu_exec_object& elf, utils::serial* ar)
 	_main.path = vfs::get(Emu.argv[0]);
 
 	// Analyse executable (TODO)
-	_main.analyse(0, static_cast<u32>(elf.header.e_entry), end, applied);
+	_main.analyse_cached(0, static_cast<u32>(elf.header.e_entry), end, applied);
 
 	// Validate analyser results (not required)
 	_main.validate(0);
@@ -2352,7 +2352,7 @@ std::pair<std::shared_ptr<lv2_overlay>, CellError> ppu_load_overlay(const ppu_ex
 	ovlm->entry = static_cast<u32>(elf.header.e_entry);
 
 	// Analyse executable (TODO)
-	ovlm->analyse(0, ovlm->entry, end, applied);
+	ovlm->analyse_cached(0, ovlm->entry, end, applied);
 
 	// Validate analyser results (not required)
 	ovlm->validate(0);
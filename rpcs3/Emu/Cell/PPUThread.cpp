@@ -13,6 +13,7 @@
 #include "Emu/VFS.h"
 #include "Emu/system_progress.hpp"
 #include "Emu/system_utils.hpp"
+#include "Emu/cache_utils.hpp"
 #include "PPUThread.h"
 #include "PPUInterpreter.h"
 #include "PPUAnalyser.h"
@@ -428,6 +429,14 @@ static void ppu_fallback(ppu_thread& ppu, ppu_opcode_t op, be_t<u32>* this_op, p
 	return _fn(ppu, op, this_op, next_fn);
 }
 
+// Addresses recently sampled by ppu_recompiler_fallback, used to prioritize tiered PPU LLVM compilation
+// Each thread writes into its own row (no shared read-modify-write), the tier workers collect and clear the entries
+alignas(64) static atomic_t<u32> s_fallback_hits[64][64]{};
+static atomic_t<u32> s_fallback_rows = 0;
+
+// Set by a tier worker waiting for new samples
+static atomic_t<u32> s_fallback_wanted = 0;
+
 // TODO: Make this a dispatch call
 void ppu_recompiler_fallback(ppu_thread& ppu)
 {
@@ -440,7 +449,9 @@ void ppu_recompiler_fallback(ppu_thread& ppu)
 
 	const auto& table = g_fxo->get<ppu_interpreter_rt>();
 
-	while (true)
+	const bool sample = g_cfg.core.ppu_llvm_tiered || g_cfg.core.ppu_llvm_lazy;
+
+	for (u32 count = 0;; count++)
 	{
 		if (uptr func = uptr(ppu_ref(ppu.cia)); (func << 16 >> 16) != reinterpret_cast<uptr>(ppu_recompiler_fallback_ghc))
 		{
@@ -448,6 +459,21 @@ void ppu_recompiler_fallback(ppu_thread& ppu)
 			break;
 		}
 
+		if (sample && count % 256 == 0)
+		{
+			// Record the entry point and then every 256th instruction
+			thread_local const u32 row = s_fallback_rows++ % std::size(s_fallback_hits);
+			thread_local u32 pos = 0;
+
+			s_fallback_hits[row][pos++ % std::size(s_fallback_hits[0])].release(ppu.cia);
+
+			if (s_fallback_wanted) [[unlikely]]
+			{
+				s_fallback_wanted.release(0);
+				s_fallback_wanted.notify_all();
+			}
+		}
+
 		// Run one instruction in interpreter (TODO)
 		const u32 op = vm::read32(ppu.cia);
 		table.decode(op)(ppu, {op}, vm::_ptr<u32>(ppu.cia), &ppu_ret);
@@ -2600,12 +2626,78 @@ extern bool ppu_stdcx(ppu_thread& ppu, u32 addr, u64 reg_value)
 #ifdef LLVM_AVAILABLE
 namespace
 {
+	struct jit_core_allocator
+	{
+		const s32 thread_count = g_cfg.core.llvm_threads ? std::min<s32>(g_cfg.core.llvm_threads, limit()) : limit();
+
+		// Initialize global semaphore with the max number of threads
+		::semaphore<0x7fffffff> sem{std::max<s32>(thread_count, 1)};
+
+		static s32 limit()
+		{
+			return static_cast<s32>(utils::get_thread_count());
+		}
+	};
+
+	// Background compilation of the missing parts of a module (tiered mode)
+	// Until its object is linked, a function keeps running in ppu_recompiler_fallback (the per-instruction interpreter, there is no faster baseline tier)
+	struct ppu_llvm_tier
+	{
+		std::shared_ptr<jit_compiler> jit;
+		std::string obj_path;
+
+		// Parts to compile (object name, module part)
+		std::vector<std::pair<std::string, ppu_module>> workload;
+
+		// All functions of the module (address, symbol name) and their installed pointers
+		std::vector<std::pair<u32, std::string>> symbols;
+		std::vector<ppu_intrp_func_t> funcs;
+
+		// Indices of the symbols which are not installed yet
+		std::vector<u32> pending;
+
+		// Only compile the parts which were entered through the interpreter fallback
+		bool lazy = false;
+
+		// Install all pending functions which are available in the JIT
+		void install()
+		{
+			std::erase_if(pending, [&](u32 index)
+			{
+				const auto& [addr, name] = symbols[index];
+				const auto ptr = reinterpret_cast<ppu_intrp_func_t>(jit->get(name));
+
+				if (!ptr)
+				{
+					return false;
+				}
+
+				funcs[index] = ptr;
+
+				if (ppu_ref(addr) != ppu_far_jump)
+					ppu_register_function_at(addr, 4, ptr);
+
+				if (g_cfg.core.ppu_debug)
+					ppu_log.notice("Installing function %s at 0x%x: %p", name, addr, ppu_ref(addr));
+
+				return true;
+			});
+		}
+
+		void operator()();
+
+		static constexpr auto thread_name = "PPU LLVM Tier"sv;
+	};
+
 	// Compiled PPU module info
 	struct jit_module
 	{
 		std::vector<ppu_intrp_func_t> funcs;
 		std::shared_ptr<jit_compiler> pjit;
 		bool init = false;
+
+		// Must be destroyed (joined) before the JIT instance
+		std::unique_ptr<named_thread<ppu_llvm_tier>> tier;
 	};
 
 	struct jit_module_manager
@@ -3261,6 +3353,20 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 		}
 	}
 
+	// Objects are named by their code hash (module hash for relocatable modules), settings and CPU, so the shared store can hold them for all titles
+	// The module cache directory only keeps the manifest of the objects it uses
+	std::string obj_path = cache_path;
+
+	if (g_cfg.core.ppu_llvm_object_store && !cache_path.empty())
+	{
+		obj_path = rpcs3::cache::get_object_store();
+
+		if (!fs::create_path(obj_path))
+		{
+			fmt::throw_exception("Failed to create object store directory: %s (%s)", obj_path, fs::g_tls_error);
+		}
+	}
+
 #ifdef LLVM_AVAILABLE
 	std::optional<scoped_progress_dialog> progr;
 
@@ -3270,21 +3376,29 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 		progr.emplace("Loading PPU modules...");
 	}
 
-	struct jit_core_allocator
+	// Permanently loaded compiled PPU modules (name -> data)
+	jit_module& jit_mod = g_fxo->get<jit_module_manager>().get(cache_path + info.name);
+
+	if (jit_mod.tier && jit_mod.tier->lazy)
 	{
-		const s32 thread_count = g_cfg.core.llvm_threads ? std::min<s32>(g_cfg.core.llvm_threads, limit()) : limit();
+		// Functions are installed by the background thread as soon as they are compiled
+		// Until then, calls to them go through the executable table to the interpreter fallback (see ppu_attr::indirect_calls)
+		return false;
+	}
 
-		// Initialize global semaphore with the max number of threads
-		::semaphore<0x7fffffff> sem{std::max<s32>(thread_count, 1)};
+	if (jit_mod.tier && !check_only)
+	{
+		// Wait for the background compilation started by the previous initialization
+		(*jit_mod.tier)();
 
-		static s32 limit()
+		if (jit_mod.tier->pending.empty())
 		{
-			return static_cast<s32>(utils::get_thread_count());
+			jit_mod.funcs = std::move(jit_mod.tier->funcs);
+			jit_mod.init = true;
 		}
-	};
 
-	// Permanently loaded compiled PPU modules (name -> data)
-	jit_module& jit_mod = g_fxo->get<jit_module_manager>().get(cache_path + info.name);
+		jit_mod.tier.reset();
+	}
 
 	// Compiler instance (deferred initialization)
 	std::shared_ptr<jit_compiler>& jit = jit_mod.pjit;
@@ -3344,6 +3458,9 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 		}
 	}
 
+	// Tiered and lazy compilation link the parts of the main module at different times (or never), so the linker can't resolve the calls between them
+	const bool link_deferred = (g_cfg.core.ppu_llvm_tiered || g_cfg.core.ppu_llvm_lazy) && info.name.empty();
+
 	while (!jit_mod.init && fpos < info.funcs.size())
 	{
 		// Initialize compiler instance
@@ -3391,6 +3508,11 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 				entry.attr += ppu_attr::has_mfvscr;
 			}
 
+			if (link_deferred)
+			{
+				entry.attr += ppu_attr::indirect_calls;
+			}
+
 			if (entry.blocks.empty())
 			{
 				entry.blocks.emplace(func.addr, func.size);
@@ -3496,6 +3618,12 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 				sha1_update(&ctx, reinterpret_cast<const u8*>(&forced_upd), sizeof(forced_upd));
 			}
 
+			if (reloc && obj_path != cache_path)
+			{
+				// The code of relocatable modules is not hashed (only function addresses and sizes), objects in the shared store also need the module hash
+				sha1_update(&ctx, info.sha1, sizeof(info.sha1));
+			}
+
 			sha1_finish(&ctx, output);
 
 			// Settings: should be populated by settings which affect codegen (TODO)
@@ -3512,6 +3640,7 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 				accurate_fpcc,
 				accurate_vnan,
 				accurate_nj_mode,
+				indirect_calls,
 
 				__bitset_enum_max
 			};
@@ -3535,6 +3664,8 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 				settings += ppu_settings::greedy_mode;
 			if (has_mfvscr && g_cfg.core.ppu_set_sat_bit)
 				settings += ppu_settings::accurate_sat;
+			if (link_deferred)
+				settings += ppu_settings::indirect_calls;
 			if (g_cfg.core.ppu_set_fpcc)
 				settings += ppu_settings::accurate_fpcc, fmt::throw_exception("FPCC Not implemented");
 			if (g_cfg.core.ppu_set_vnan)
@@ -3559,8 +3690,8 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 			link_workload.emplace_back(obj_name, false);
 		}
 
-		// Check object file
-		if (jit_compiler::check(cache_path + obj_name))
+		// Check object file (objects compiled before the store was used are moved into it)
+		if (jit_compiler::check(obj_path + obj_name) || (obj_path != cache_path && jit_compiler::check(cache_path + obj_name) && fs::rename(cache_path + obj_name + ".gz", obj_path + obj_name + ".gz", true)))
 		{
 			if (!jit && !check_only)
 			{
@@ -3593,6 +3724,63 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 		return false;
 	}
 
+	if (obj_path != cache_path && !Emu.IsStopped())
+	{
+		std::vector<std::string> objects;
+
+		for (const auto& [obj_name, is_compiled] : link_workload)
+		{
+			objects.emplace_back(obj_name);
+		}
+
+		rpcs3::cache::write_object_manifest(cache_path, objects);
+	}
+
+	// Tiered mode: start the executable with the cached objects and compile the rest in background
+	// Only the main module is permanently loaded, PRX modules may be unloaded while compiling
+	if ((g_cfg.core.ppu_llvm_tiered || g_cfg.core.ppu_llvm_lazy) && info.name.empty() && !workload.empty() && jit && get_current_cpu_thread())
+	{
+		ppu_llvm_tier tier{jit, obj_path};
+		tier.lazy = g_cfg.core.ppu_llvm_lazy;
+
+		for (const auto& func : info.funcs)
+		{
+			if (!func.size) continue;
+
+			tier.pending.emplace_back(::size32(tier.symbols));
+			tier.symbols.emplace_back(func.addr, fmt::format("__0x%x", func.addr - reloc));
+		}
+
+		tier.funcs.resize(tier.symbols.size());
+
+		for (const auto& [obj_name, is_compiled] : link_workload)
+		{
+			if (is_compiled)
+			{
+				// Not shown in the progress dialog
+				g_progr_ptotal--;
+				continue;
+			}
+
+			jit->add(obj_path + obj_name);
+
+			ppu_log.success("LLVM: Loaded module %s", obj_name);
+			g_progr_pdone++;
+		}
+
+#ifdef __APPLE__
+		pthread_jit_write_protect_np(false);
+#endif
+		jit->fin();
+		tier.install();
+
+		ppu_log.notice("LLVM: %u of %u functions installed, compiling %u modules %s", tier.symbols.size() - tier.pending.size(), tier.symbols.size(), workload.size(), tier.lazy ? "on demand" : "in background");
+
+		tier.workload = std::move(workload);
+		jit_mod.tier = std::make_unique<named_thread<ppu_llvm_tier>>(std::move(tier));
+		return compiled_new;
+	}
+
 	if (!workload.empty())
 	{
 		g_progr = "Compiling PPU modules...";
@@ -3636,11 +3824,11 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 				// Allocate "core"
 				std::lock_guard jlock(g_fxo->get<jit_core_allocator>().sem);
 
-				ppu_log.warning("LLVM: Compiling module %s%s", cache_path, obj_name);
+				ppu_log.warning("LLVM: Compiling module %s%s", obj_path, obj_name);
 
 				// Use another JIT instance
 				jit_compiler jit2({}, g_cfg.core.llvm_cpu, 0x1);
-				ppu_initialize2(jit2, part, cache_path, obj_name);
+				ppu_initialize2(jit2, part, obj_path, obj_name);
 
 				ppu_log.success("LLVM: Compiled module %s", obj_name);
 			}
@@ -3668,7 +3856,7 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 				break;
 			}
 
-			jit->add(cache_path + obj_name);
+			jit->add(obj_path + obj_name);
 
 			if (!is_compiled)
 			{
@@ -3736,6 +3924,186 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 #endif
 }
 
+#ifdef LLVM_AVAILABLE
+void ppu_llvm_tier::operator()()
+{
+#ifdef __APPLE__
+	pthread_jit_write_protect_np(false);
+#endif
+	// Function ranges of the parts (start, end, part index), sorted
+	std::vector<std::tuple<u32, u32, u32>> ranges;
+
+	for (u32 i = 0; i < workload.size(); i++)
+	{
+		for (const auto& func : workload[i].second.funcs)
+		{
+			if (func.size)
+			{
+				ranges.emplace_back(func.addr, func.addr + func.size, i);
+			}
+		}
+	}
+
+	std::sort(ranges.begin(), ranges.end());
+
+	// Number of entries into the interpreter fallback per part, -1 once the part is taken by a worker
+	std::vector<s64> hits(workload.size());
+	shared_mutex hits_mutex;
+
+	// Indices of compiled parts
+	lf_queue<u32> compiled;
+
+	atomic_t<bool> stop = false;
+
+	// Collect the samples of the interpreter fallback (called with hits_mutex locked)
+	const auto collect_hits = [&]()
+	{
+		for (auto& row : s_fallback_hits)
+		{
+			for (auto& entry : row)
+			{
+				if (!entry)
+				{
+					continue;
+				}
+
+				const u32 addr = entry.exchange(0);
+
+				auto found = std::upper_bound(ranges.begin(), ranges.end(), addr, [](u32 addr, const std::tuple<u32, u32, u32>& range)
+				{
+					return addr < std::get<0>(range);
+				});
+
+				if (found != ranges.begin() && addr < std::get<1>(*--found) && hits[std::get<2>(*found)] >= 0)
+				{
+					hits[std::get<2>(*found)]++;
+				}
+			}
+		}
+	};
+
+	named_thread_group workers("PPUW.Tier.", std::min<u32>(rpcs3::utils::get_max_threads(), ::size32(workload)), [&]()
+	{
+		// Set low priority
+		thread_ctrl::scoped_priority low_prio(-1);
+
+#ifdef __APPLE__
+		pthread_jit_write_protect_np(false);
+#endif
+		while (!stop && !Emu.IsStopped())
+		{
+			u32 index = umax;
+			bool all_taken = true;
+
+			if (lazy)
+			{
+				// Request a notification on the next sample before collecting, so that none is missed
+				s_fallback_wanted = 1;
+			}
+
+			{
+				std::lock_guard lock(hits_mutex);
+
+				collect_hits();
+
+				// Take the most executed part (in lazy mode, parts which never ran are skipped)
+				s64 max = lazy ? 0 : -1;
+
+				for (u32 i = 0; i < hits.size(); i++)
+				{
+					all_taken &= hits[i] < 0;
+
+					if (hits[i] > max)
+					{
+						max = hits[i];
+						index = i;
+					}
+				}
+
+				if (index != umax)
+				{
+					hits[index] = -1;
+				}
+			}
+
+			if (index == umax)
+			{
+				if (!lazy || all_taken)
+				{
+					// Everything has been taken
+					break;
+				}
+
+				if (stop)
+				{
+					// Checked after setting the request, see below
+					break;
+				}
+
+				// Wait for the interpreter fallback to run again
+				thread_ctrl::wait_on(s_fallback_wanted, 1);
+				continue;
+			}
+
+			const auto& [obj_name, part] = std::as_const(workload)[index];
+
+			// Allocate "core"
+			std::lock_guard jlock(g_fxo->get<jit_core_allocator>().sem);
+
+			ppu_log.warning("LLVM: Compiling module %s%s in background", obj_path, obj_name);
+
+			jit_compiler jit2({}, g_cfg.core.llvm_cpu, 0x1);
+			ppu_initialize2(jit2, part, obj_path, obj_name);
+
+			ppu_log.success("LLVM: Compiled module %s", obj_name);
+			compiled.push(index);
+		}
+	});
+
+	for (usz linked = 0; linked < workload.size();)
+	{
+		if (Emu.IsStopped() || thread_ctrl::state() == thread_state::aborting)
+		{
+			break;
+		}
+
+		if (!compiled)
+		{
+			thread_ctrl::wait_on(compiled, nullptr);
+			continue;
+		}
+
+		for (u32 index : compiled.pop_all())
+		{
+			jit->add(obj_path + workload[index].first);
+			linked++;
+		}
+
+		jit->fin();
+		install();
+
+#ifdef ARCH_ARM64
+		// Flush all cache lines after writing executable code
+		asm("ISB");
+		asm("DSB ISH");
+#endif
+	}
+
+	stop = true;
+
+	// Wake up the workers waiting for samples
+	s_fallback_wanted = 0;
+	s_fallback_wanted.notify_all();
+
+	workers.join();
+
+	if (pending.empty())
+	{
+		ppu_log.success("LLVM: Background compilation finished (%u modules)", workload.size());
+	}
+}
+#endif
+
 static void ppu_initialize2(jit_compiler& jit, const ppu_module& module_part, const std::string& cache_path, const std::string& obj_name)
 {
 #ifdef LLVM_AVAILABLE
@@ -114,6 +114,14 @@ PPUTranslator::PPUTranslator(LLVMContext& context, Module* _module, const ppu_mo
 		m_reloc = &m_info.segs[0];
 	}
 
+	for (const auto& func : m_info.funcs)
+	{
+		if (func.size)
+		{
+			m_part_funcs.emplace(func.addr);
+		}
+	}
+
 	const auto nan_v = v128::from32p(0x7FC00000u);
 	nan_vec4 = make_const_vector(nan_v, get_type<f32[4]>());
 }
@@ -364,7 +372,7 @@ void PPUTranslator::CallFunction(u64 target, Value* indirect)
 		const u32 cend = caddr + m_info.segs[0].size - 1;
 		const u64 _target = target + base;
 
-		if (_target >= caddr && _target <= cend)
+		if (_target >= caddr && _target <= cend && (!(m_attr & ppu_attr::indirect_calls) || m_part_funcs.count(_target)))
 		{
 			callee = m_module->getOrInsertFunction(fmt::format("__0x%x", target), type);
 			cast<Function>(callee.getCallee())->setCallingConv(CallingConv::GHC);
@@ -16,6 +16,9 @@ class PPUTranslator final : public cpu_translator
 	// Relevant relocations
 	std::map<u64, const ppu_reloc*> m_relocs;
 
+	// Functions defined in this module part
+	std::set<u64> m_part_funcs;
+
 	// Attributes for function calls which are "pure" and may be optimized away if their results are unused
 	const llvm::AttributeList m_pure_attr;
 
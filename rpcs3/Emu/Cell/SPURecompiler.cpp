@@ -12,6 +12,8 @@
 #include "Utilities/StrUtil.h"
 #include "Utilities/JIT.h"
 #include "util/init_mutex.hpp"
+#include "util/serialization.hpp"
+#include "xxhash.h"
 
 #include "SPUThread.h"
 #include "SPUAnalyser.h"
@@ -21,6 +23,7 @@
 #include <mutex>
 #include <thread>
 #include <optional>
+#include <span>
 #include <unordered_set>
 
 #include "util/v128.hpp"
@@ -378,6 +381,109 @@ void spu_cache::add(const spu_program& func)
 	m_file.write_gather(gather, 3);
 }
 
+struct spu_analysis_record
+{
+	u64 key;
+	u64 checksum;
+	u32 size;
+	u32 reserved;
+};
+
+void spu_analysis_cache::open(const std::string& loc)
+{
+	if (!m_file.open(loc, fs::read + fs::write + fs::create))
+	{
+		spu_log.error("Failed to open SPU analysis cache at: %s (%s)", loc, fs::g_tls_error);
+		return;
+	}
+
+	u32 file_version = 0;
+
+	if (!m_file.read(file_version) || file_version != version)
+	{
+		// Empty or written by another version of the analyser
+		m_file.trunc(0);
+		m_file.seek(0);
+		m_file.write(version);
+	}
+
+	const u64 file_size = m_file.size();
+
+	while (true)
+	{
+		const u64 pos = m_file.pos();
+
+		spu_analysis_record header{};
+
+		if (!m_file.read(header) || file_size - m_file.pos() < header.size)
+		{
+			// Drop the incomplete record at the end, if any
+			m_file.trunc(pos);
+			break;
+		}
+
+		m_index.try_emplace(header.key, pos, header.size);
+		m_file.seek(header.size, fs::seek_cur);
+	}
+
+	spu_log.notice("SPU analysis cache: %u programs indexed.", m_index.size());
+}
+
+u64 spu_analysis_cache::get_key(const spu_program& func)
+{
+	return XXH64(func.data.data(), func.data.size() * 4, (u64{func.entry_point} << 32) | func.lower_bound);
+}
+
+bool spu_analysis_cache::load(u64 key, std::vector<u8>& out)
+{
+	std::lock_guard lock(m_mutex);
+
+	const auto found = m_index.find(key);
+
+	if (found == m_index.end())
+	{
+		return false;
+	}
+
+	spu_analysis_record header{};
+	out.resize(found->second.second);
+	m_file.seek(found->second.first);
+
+	if (!m_file.read(header) || header.key != key || m_file.read(out.data(), out.size()) != out.size() || XXH64(out.data(), out.size(), 0) != header.checksum)
+	{
+		spu_log.error("SPU analysis cache: corrupted record 0x%016x", key);
+		m_index.erase(found);
+		return false;
+	}
+
+	return true;
+}
+
+void spu_analysis_cache::store(u64 key, const std::vector<u8>& data)
+{
+	std::lock_guard lock(m_mutex);
+
+	if (!m_file || m_index.contains(key))
+	{
+		return;
+	}
+
+	const spu_analysis_record header{key, XXH64(data.data(), data.size(), 0), ::size32(data), 0};
+
+	const fs::iovec_clone gather[2]
+	{
+		{&header, sizeof(header)},
+		{data.data(), data.size()}
+	};
+
+	const u64 pos = m_file.seek(0, fs::seek_end);
+
+	if (m_file.write_gather(gather, 2) == sizeof(header) + data.size())
+	{
+		m_index.try_emplace(key, pos, ::size32(data));
+	}
+}
+
 void spu_cache::initialize()
 {
 	spu_runtime::g_interpreter = spu_runtime::g_gateway;
@@ -408,6 +514,9 @@ void spu_cache::initialize()
 		return;
 	}
 
+	// Analyser state of the cached programs
+	g_fxo->get<spu_analysis_cache>().open(ppu_cache + "spu-" + fmt::to_lower(g_cfg.core.spu_block_size.to_string()) + "-analysis.dat");
+
 	// Read cache
 	auto func_list = cache.get();
 	atomic_t<usz> fnext{};
@@ -478,65 +587,76 @@ void spu_cache::initialize()
 		// Fake LS
 		std::vector<be_t<u32>> ls(0x10000);
 
-		// Build functions
-		for (usz func_i = fnext++; func_i < func_list.size(); func_i = fnext++, g_progr_pdone++)
+		// Build functions, claimed in batches which are hashed together (multi-buffer SHA-1)
+		static constexpr usz batch_size = 8;
+
+		for (usz batch = fnext.fetch_add(batch_size); batch < func_list.size(); batch = fnext.fetch_add(batch_size))
 		{
-			const spu_program& func = std::as_const(func_list)[func_i];
+			const usz batch_end = std::min(batch + batch_size, func_list.size());
+
+			const u8* inputs[batch_size]{};
+			usz sizes[batch_size]{};
+			u8 digests[batch_size][20]{};
 
-			if (Emu.IsStopped() || fail_flag)
+			for (usz i = batch; i < batch_end; i++)
 			{
-				continue;
+				inputs[i - batch] = reinterpret_cast<const u8*>(func_list[i].data.data());
+				sizes[i - batch] = func_list[i].data.size() * 4;
 			}
 
-			// Get data start
-			const u32 start = func.lower_bound;
-			const u32 size0 = ::size32(func.data);
+			sha1_multi(inputs, sizes, digests, batch_end - batch);
 
-			be_t<u64> hash_start;
+			for (usz func_i = batch; func_i < batch_end; func_i++, g_progr_pdone++)
 			{
-				sha1_context ctx;
-				u8 output[20];
+				const spu_program& func = std::as_const(func_list)[func_i];
 
-				sha1_starts(&ctx);
-				sha1_update(&ctx, reinterpret_cast<const u8*>(func.data.data()), func.data.size() * 4);
-				sha1_finish(&ctx, output);
-				std::memcpy(&hash_start, output, sizeof(hash_start));
-			}
+				if (Emu.IsStopped() || fail_flag)
+				{
+					continue;
+				}
 
-			// Check hash against allowed bounds
-			const bool inverse_bounds = g_cfg.core.spu_llvm_lower_bound > g_cfg.core.spu_llvm_upper_bound;
+				// Get data start
+				const u32 start = func.lower_bound;
+				const u32 size0 = ::size32(func.data);
 
-			if ((!inverse_bounds && (hash_start < g_cfg.core.spu_llvm_lower_bound || hash_start > g_cfg.core.spu_llvm_upper_bound)) ||
-				(inverse_bounds && (hash_start < g_cfg.core.spu_llvm_lower_bound && hash_start > g_cfg.core.spu_llvm_upper_bound)))
-			{
-				spu_log.error("[Debug] Skipped function %s", fmt::base57(hash_start));
-				result++;
-				continue;
-			}
+				be_t<u64> hash_start;
+				std::memcpy(&hash_start, digests[func_i - batch], sizeof(hash_start));
 
-			// Initialize LS with function data only
-			for (u32 i = 0, pos = start; i < size0; i++, pos += 4)
-			{
-				ls[pos / 4] = std::bit_cast<be_t<u32>>(func.data[i]);
-			}
+				// Check hash against allowed bounds
+				const bool inverse_bounds = g_cfg.core.spu_llvm_lower_bound > g_cfg.core.spu_llvm_upper_bound;
 
-			// Call analyser
-			spu_program func2 = compiler->analyse(ls.data(), func.entry_point);
+				if ((!inverse_bounds && (hash_start < g_cfg.core.spu_llvm_lower_bound || hash_start > g_cfg.core.spu_llvm_upper_bound)) ||
+					(inverse_bounds && (hash_start < g_cfg.core.spu_llvm_lower_bound && hash_start > g_cfg.core.spu_llvm_upper_bound)))
+				{
+					spu_log.error("[Debug] Skipped function %s", fmt::base57(hash_start));
+					result++;
+					continue;
+				}
 
-			if (func2 != func)
-			{
-				spu_log.error("[0x%05x] SPU Analyser failed, %u vs %u", func2.entry_point, func2.data.size(), size0);
-			}
-			else if (!compiler->compile(std::move(func2)))
-			{
-				// Likely, out of JIT memory. Signal to prevent further building.
-				fail_flag |= 1;
-			}
+				// Initialize LS with function data only
+				for (u32 i = 0, pos = start; i < size0; i++, pos += 4)
+				{
+					ls[pos / 4] = std::bit_cast<be_t<u32>>(func.data[i]);
+				}
 
-			// Clear fake LS
-			std::memset(ls.data() + start / 4, 0, 4 * (size0 - 1));
+				// Call analyser
+				spu_program func2 = compiler->analyse_cached(ls.data(), func);
 
-			result++;
+				if (func2 != func)
+				{
+					spu_log.error("[0x%05x] SPU Analyser failed, %u vs %u", func2.entry_point, func2.data.size(), size0);
+				}
+				else if (!compiler->compile(std::move(func2)))
+				{
+					// Likely, out of JIT memory. Signal to prevent further building.
+					fail_flag |= 1;
+				}
+
+				// Clear fake LS
+				std::memset(ls.data() + start / 4, 0, 4 * (size0 - 1));
+
+				result++;
+			}
 		}
 
 		return result;
@@ -3267,6 +3387,217 @@ spu_program spu_recompiler_base::analyse(const be_t<u32>* ls, u32 entry_point)
 	return result;
 }
 
+namespace
+{
+	// Only the set bits are stored, the large bitsets are sparse
+	template <usz N>
+	void serialize_bits(utils::serial& ar, std::bitset<N>& bits)
+	{
+		std::vector<u32> set;
+
+		if (ar.is_writing())
+		{
+			for (u32 i = 0; i < N; i++)
+			{
+				if (bits[i])
+				{
+					set.push_back(i);
+				}
+			}
+
+			ar(set);
+			return;
+		}
+
+		ar(set);
+		bits.reset();
+
+		for (u32 i : set)
+		{
+			if (i < N)
+			{
+				bits.set(i);
+			}
+		}
+	}
+
+	// Only the range of instructions which have a register assigned is stored
+	bool serialize_insts(utils::serial& ar, std::array<u8, 0x10000>& regs)
+	{
+		u32 first = 0;
+		u32 count = 0;
+
+		if (ar.is_writing())
+		{
+			const auto is_set = [](u8 reg) { return reg != 0xff; };
+			const auto begin = std::find_if(regs.begin(), regs.end(), is_set);
+			const auto end = std::find_if(regs.rbegin(), regs.rend(), is_set).base();
+
+			if (begin < end)
+			{
+				first = static_cast<u32>(begin - regs.begin());
+				count = static_cast<u32>(end - begin);
+			}
+		}
+
+		ar(first, count);
+
+		if (!ar.is_writing())
+		{
+			if (first > regs.size() || count > regs.size() - first)
+			{
+				return false;
+			}
+
+			std::memset(regs.data(), 0xff, sizeof(regs));
+		}
+
+		ar(std::span<u8>(regs.data() + first, count));
+		return true;
+	}
+
+	// Register value arrays are mostly filled with the same value, store the difference to the previous element
+	template <usz N>
+	void serialize_regs(utils::serial& ar, std::array<u32, N>& regs)
+	{
+		u32 prev = 0;
+
+		for (u32& value : regs)
+		{
+			if (ar.is_writing())
+			{
+				ar.serialize_vle(value ^ prev);
+			}
+			else
+			{
+				u32 diff = 0;
+				ar.deserialize_vle(diff);
+				value = diff ^ prev;
+			}
+
+			prev = value;
+		}
+	}
+
+	template <typename Map>
+	void serialize_addr_map(utils::serial& ar, Map& map, const std::function<void(typename Map::mapped_type&)>& serialize_value)
+	{
+		usz count = map.size();
+
+		if (ar.is_writing())
+		{
+			ar.serialize_vle(count);
+
+			for (auto& [addr, value] : map)
+			{
+				u32 key = addr;
+				ar(key);
+				serialize_value(value);
+			}
+
+			return;
+		}
+
+		map.clear();
+		ar.deserialize_vle(count);
+
+		for (usz i = 0; i < count && ar.is_valid(); i++)
+		{
+			u32 key = 0;
+			ar(key);
+			serialize_value(map[key]);
+		}
+	}
+}
+
+bool spu_recompiler_base::serialize_analysis(utils::serial& ar, spu_program& func)
+{
+	u32 size = ::size32(func.data);
+	ar(func.entry_point, func.lower_bound, size);
+
+	if (size != func.data.size())
+	{
+		return false;
+	}
+
+	serialize_bits(ar, m_block_info);
+	serialize_bits(ar, m_entry_info);
+	serialize_bits(ar, m_ret_info);
+
+	for (auto regs : {&m_regmod, &m_use_ra, &m_use_rb, &m_use_rc})
+	{
+		if (!serialize_insts(ar, *regs))
+		{
+			return false;
+		}
+	}
+
+	const auto serialize_list = [&](std::basic_string<u32>& list)
+	{
+		ar(list);
+	};
+
+	serialize_addr_map(ar, m_targets, serialize_list);
+	serialize_addr_map(ar, m_preds, serialize_list);
+	ar(m_chunks);
+
+	serialize_addr_map(ar, m_bbs, [&](block_info& bb)
+	{
+		ar(bb.chunk, bb.size, bb.analysed, bb.terminator, bb.func, bb.stack_sub, bb.targets, bb.preds);
+
+		for (auto bits : {&bb.reg_mod, &bb.reg_mod_xf, &bb.reg_maybe_xf, &bb.reg_use, &bb.reg_const, &bb.reg_save_dom})
+		{
+			serialize_bits(ar, *bits);
+		}
+
+		for (auto regs : {&bb.reg_val32, &bb.reg_load_mod, &bb.reg_origin, &bb.reg_origin_abs})
+		{
+			serialize_regs(ar, *regs);
+		}
+	});
+
+	serialize_addr_map(ar, m_funcs, [&](func_info& f)
+	{
+		ar(f.size, f.good, f.calls);
+		serialize_regs(ar, f.reg_save_off);
+	});
+
+	return ar.is_valid();
+}
+
+spu_program spu_recompiler_base::analyse_cached(const be_t<u32>* ls, const spu_program& func)
+{
+	auto& cache = g_fxo->get<spu_analysis_cache>();
+	const u64 key = spu_analysis_cache::get_key(func);
+
+	utils::serial ar;
+
+	if (cache.load(key, ar.data))
+	{
+		ar.set_reading_state();
+
+		spu_program result = func;
+
+		if (serialize_analysis(ar, result) && result == func)
+		{
+			return result;
+		}
+
+		spu_log.error("[0x%05x] SPU analysis cache: invalid record 0x%016x", func.entry_point, key);
+	}
+
+	spu_program result = analyse(ls, func.entry_point);
+
+	if (result == func && g_cfg.core.spu_cache)
+	{
+		ar.clear();
+		serialize_analysis(ar, result);
+		cache.store(key, ar.data);
+	}
+
+	return result;
+}
+
 void spu_recompiler_base::dump(const spu_program& result, std::string& out)
 {
 	SPUDisAsm dis_asm(cpu_disasm_mode::dump, reinterpret_cast<const u8*>(result.data.data()), result.lower_bound);
@@ -4457,8 +4788,8 @@ public:
 		u32 check_iterations = 0;
 		m_ir->SetInsertPoint(label_test);
 
-		// Set block hash for profiling (if enabled)
-		if (g_cfg.core.spu_prof && g_cfg.core.spu_verification)
+		// Set block hash for profiling (if enabled, also read by the guest profiler)
+		if ((g_cfg.core.spu_prof || g_cfg.core.guest_profiler) && g_cfg.core.spu_verification)
 			m_ir->CreateStore(m_ir->getInt64((m_hash_start & -65536)), spu_ptr<u64>(&spu_thread::block_hash), true);
 
 		if (!g_cfg.core.spu_verification)
@@ -4709,8 +5040,8 @@ public:
 			m_entry = m_function_queue[fi];
 			set_function(m_functions[m_entry].chunk);
 
-			// Set block hash for profiling (if enabled)
-			if (g_cfg.core.spu_prof)
+			// Set block hash for profiling (if enabled, also read by the guest profiler)
+			if (g_cfg.core.spu_prof || g_cfg.core.guest_profiler)
 				m_ir->CreateStore(m_ir->getInt64((m_hash_start & -65536) | (m_entry >> 2)), spu_ptr<u64>(&spu_thread::block_hash), true);
 
 			m_finfo = &m_functions[m_entry];
@@ -10057,7 +10388,7 @@ struct spu_llvm_worker
 			}
 
 			// Call analyser
-			spu_program func2 = compiler->analyse(ls.data(), func.entry_point);
+			spu_program func2 = compiler->analyse_cached(ls.data(), func);
 
 			if (func2 != func)
 			{
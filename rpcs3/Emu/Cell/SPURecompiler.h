@@ -8,6 +8,12 @@
 #include <memory>
 #include <string>
 #include <deque>
+#include <unordered_map>
+
+namespace utils
+{
+	struct serial;
+}
 
 // Helper class
 class spu_cache
@@ -37,6 +43,33 @@ public:
 	static void initialize();
 };
 
+// Persistent analyser state of the programs built from spu_cache, stored in a companion file
+class spu_analysis_cache
+{
+	fs::file m_file;
+
+	shared_mutex m_mutex;
+
+	// Program key -> offset and size of the serialized state
+	std::unordered_map<u64, std::pair<u64, u32>> m_index;
+
+public:
+	// Must be incremented whenever the analyser output or its serialization changes
+	static constexpr u32 version = 1;
+
+	// Open the file and index its records, recreate it if it was written by another version
+	void open(const std::string& loc);
+
+	// Get the lookup key of a program
+	static u64 get_key(const struct spu_program& func);
+
+	// Read the serialized state of a program
+	bool load(u64 key, std::vector<u8>& out);
+
+	// Append the serialized state of a program
+	void store(u64 key, const std::vector<u8>& data);
+};
+
 struct spu_program
 {
 	// Address of the entry point in LS
@@ -317,6 +350,12 @@ public:
 	// Get the function data at specified address
 	spu_program analyse(const be_t<u32>* ls, u32 entry_point);
 
+	// Analyse a known program placed in LS, restoring the analyser state from spu_analysis_cache if possible
+	spu_program analyse_cached(const be_t<u32>* ls, const spu_program& func);
+
+	// (De)serialize the analyser state along with the program bounds
+	bool serialize_analysis(utils::serial& ar, spu_program& func);
+
 	// Print analyser internal state
 	void dump(const spu_program& result, std::string& out);
 
@@ -200,6 +200,118 @@ lv2_fs_mount_point* lv2_fs_object::get_mp(std::string_view filename)
 	return &g_mp_sys_dev_root;
 }
 
+// Get host file attributes, split files (.66600, .66601...) are reported as a single file
+static bool stat_split_file(const std::string& local_path, fs::stat_t& info)
+{
+	if (fs::stat(local_path, info))
+	{
+		return true;
+	}
+
+	if (fs::g_tls_error != fs::error::noent)
+	{
+		return false;
+	}
+
+	// Try to analyse split file (TODO)
+	u64 total_size = 0;
+
+	for (u32 i = 66601; i <= 66699; i++)
+	{
+		if (fs::stat(fmt::format("%s.%u", local_path, i), info) && !info.is_directory)
+		{
+			total_size += info.size;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	// Use attributes from the first fragment (consistently with sys_fs_open+fstat)
+	if (fs::stat(local_path + ".66600", info) && !info.is_directory)
+	{
+		info.size += total_size;
+		return true;
+	}
+
+	fs::g_tls_error = fs::error::noent;
+	return false;
+}
+
+lv2_fs_metadata_cache::~lv2_fs_metadata_cache()
+{
+	if (const u64 total = hits + misses)
+	{
+		sys_fs.notice("Metadata cache: %u hits, %u misses (%.1f%% hit rate)", hits, misses, hits * 100. / total);
+	}
+}
+
+std::shared_ptr<const lv2_fs_metadata> lv2_fs_metadata_cache::get(std::string_view vpath, const lv2_fs_mount_point* mp, bool need_info)
+{
+	// Only read-only mount points can't be modified behind the cache
+	const bool use_cache = mp->flags & lv2_mp_flag::read_only && g_cfg.vfs.cache_metadata;
+
+	std::string key;
+
+	if (use_cache)
+	{
+		key = vpath;
+
+		reader_lock lock(mutex);
+
+		if (const auto found = entries.find(key); found != entries.end())
+		{
+			hits++;
+			return found->second;
+		}
+	}
+
+	auto result = std::make_shared<lv2_fs_metadata>();
+	result->local_path = vfs::get(vpath, &result->ext, &result->ppath);
+
+	if (!result->local_path.empty() && (use_cache || need_info))
+	{
+		std::lock_guard lock(mp->mutex);
+
+		result->has_info = true;
+
+		if (!stat_split_file(result->local_path, result->info))
+		{
+			result->error = fs::g_tls_error;
+		}
+	}
+
+	if (!use_cache)
+	{
+		return result;
+	}
+
+	misses++;
+
+	if (result->error != fs::error::ok && result->error != fs::error::noent)
+	{
+		// Don't cache unexpected errors
+		return result;
+	}
+
+	std::lock_guard lock(mutex);
+
+	if (entries.size() >= max_entries)
+	{
+		entries.clear();
+	}
+
+	entries.emplace(std::move(key), result);
+	return result;
+}
+
+void lv2_fs_metadata_cache::clear()
+{
+	std::lock_guard lock(mutex);
+	entries.clear();
+}
+
 lv2_fs_object::lv2_fs_object(utils::serial& ar, bool)
 	: name(ar)
 	, mp(get_mp(name.data()))
@@ -253,6 +365,51 @@ u64 lv2_file::op_write(const fs::file& file, vm::cptr<void> buf, u64 size)
 	return result;
 }
 
+u64 lv2_file::op_read(const fs::file& file, u64 offset, vm::ptr<void> buf, u64 size)
+{
+	uchar local_buf[65536];
+
+	u64 result = 0;
+
+	while (result < size)
+	{
+		const u64 block = std::min<u64>(size - result, sizeof(local_buf));
+		const u64 nread = file.read_at(offset + result, +local_buf, block);
+
+		std::memcpy(static_cast<uchar*>(buf.get_ptr()) + result, local_buf, nread);
+		result += nread;
+
+		if (nread < block)
+		{
+			break;
+		}
+	}
+
+	return result;
+}
+
+u64 lv2_file::op_write(const fs::file& file, u64 offset, vm::cptr<void> buf, u64 size)
+{
+	uchar local_buf[65536];
+
+	u64 result = 0;
+
+	while (result < size)
+	{
+		const u64 block = std::min<u64>(size - result, sizeof(local_buf));
+		std::memcpy(local_buf, static_cast<const uchar*>(buf.get_ptr()) + result, block);
+		const u64 nwrite = file.write_at(offset + result, +local_buf, block);
+		result += nwrite;
+
+		if (nwrite < block)
+		{
+			break;
+		}
+	}
+
+	return result;
+}
+
 lv2_file::lv2_file(utils::serial& ar)
 	: lv2_fs_object(ar, false)
 	, mode(ar)
@@ -530,11 +687,12 @@ error_code sys_fs_test(ppu_thread&, u32 arg1, u32 arg2, vm::ptr<u32> arg3, u32 a
 	return CELL_OK;
 }
 
-lv2_file::open_raw_result_t lv2_file::open_raw(const std::string& local_path, s32 flags, s32 /*mode*/, lv2_file_type type, const lv2_fs_mount_point* mp)
+lv2_file::open_raw_result_t lv2_file::open_raw(const std::string& local_path, s32 flags, s32 /*mode*/, lv2_file_type type, const lv2_fs_mount_point* mp, const lv2_fs_metadata* meta)
 {
 	// TODO: other checks for path
 
-	if (fs::is_dir(local_path))
+	// Use the cached lookup if available (see lv2_fs_metadata_cache)
+	if (meta && meta->has_info ? meta->error == fs::error::ok && meta->info.is_directory : fs::is_dir(local_path))
 	{
 		return {CELL_EISDIR};
 	}
@@ -612,9 +770,14 @@ lv2_file::open_raw_result_t lv2_file::open_raw(const std::string& local_path, s3
 
 	std::lock_guard lock(mp->mutex);
 
-	fs::file file(local_path, open_mode);
+	fs::file file;
 
-	if (!file && open_mode == fs::read && fs::g_tls_error == fs::error::noent)
+	if (meta && meta->has_info && meta->error == fs::error::noent && !(open_mode & fs::create))
+	{
+		// Known to be missing, split files included
+		fs::g_tls_error = fs::error::noent;
+	}
+	else if (file.open(local_path, open_mode); !file && open_mode == fs::read && fs::g_tls_error == fs::error::noent)
 	{
 		// Try to gather split file (TODO)
 		std::vector<fs::file> fragments;
@@ -745,10 +908,11 @@ lv2_file::open_result_t lv2_file::open(std::string_view vpath, s32 flags, s32 mo
 		return {CELL_ENOENT};
 	}
 
-	std::string path;
-	std::string local_path = vfs::get(vpath, nullptr, &path);
-
 	const auto mp = lv2_fs_object::get_mp(vpath);
+	const auto meta = g_fxo->get<lv2_fs_metadata_cache>().get(vpath, mp, false);
+
+	std::string path = meta->ppath;
+	std::string local_path = meta->local_path;
 
 	if (mp == &g_mp_sys_dev_root)
 	{
@@ -774,7 +938,7 @@ lv2_file::open_result_t lv2_file::open(std::string_view vpath, s32 flags, s32 mo
 		}
 	}
 
-	auto [error, file] = open_raw(local_path, flags, mode, type, mp);
+	auto [error, file] = open_raw(local_path, flags, mode, type, mp, meta.get());
 
 	return {.error = error, .ppath = std::move(path), .real_path = std::move(local_path), .file = std::move(file), .type = type};
 }
@@ -1026,7 +1190,8 @@ error_code sys_fs_close(ppu_thread& ppu, u32 fd)
 			}
 		}
 
-		// Ensure Host file handle won't be kept open after this syscall
+		// Ensure Host file handle won't be kept open after this syscall (wait for positional operations in progress)
+		std::lock_guard io_lock(file->io_mutex);
 		file->file.close();
 	}
 
@@ -1062,13 +1227,14 @@ error_code sys_fs_opendir(ppu_thread& ppu, vm::cptr<char> path, vm::ptr<u32> fd)
 		return {path_error, vpath};
 	}
 
-	std::string processed_path;
-	std::vector<std::string> ext;
-	const std::string local_path = vfs::get(vpath, &ext, &processed_path);
+	const auto mp = lv2_fs_object::get_mp(vpath);
+	const auto meta = g_fxo->get<lv2_fs_metadata_cache>().get(vpath, mp, false);
 
-	processed_path += "/";
+	std::string processed_path = meta->ppath;
+	std::vector<std::string> ext = meta->ext;
+	const std::string& local_path = meta->local_path;
 
-	const auto mp = lv2_fs_object::get_mp(vpath);
+	processed_path += "/";
 
 	if (local_path.empty() && ext.empty())
 	{
@@ -1077,11 +1243,16 @@ error_code sys_fs_opendir(ppu_thread& ppu, vm::cptr<char> path, vm::ptr<u32> fd)
 
 	// TODO: other checks for path
 
-	if (fs::is_file(local_path))
+	if (meta->has_info ? meta->error == fs::error::ok && !meta->info.is_directory : fs::is_file(local_path))
 	{
 		return {CELL_ENOTDIR, path};
 	}
 
+	if (meta->has_info && meta->error == fs::error::noent && ext.empty())
+	{
+		return {CELL_ENOENT, path};
+	}
+
 	std::lock_guard lock(mp->mutex);
 
 	const fs::dir dir(local_path);
@@ -1223,8 +1394,6 @@ error_code sys_fs_stat(ppu_thread& ppu, vm::cptr<char> path, vm::ptr<CellFsStat>
 		return {path_error, vpath};
 	}
 
-	const std::string local_path = vfs::get(vpath);
-
 	const auto mp = lv2_fs_object::get_mp(vpath);
 
 	if (mp == &g_mp_sys_dev_root)
@@ -1240,54 +1409,26 @@ error_code sys_fs_stat(ppu_thread& ppu, vm::cptr<char> path, vm::ptr<CellFsStat>
 		return CELL_OK;
 	}
 
-	if (local_path.empty())
+	const auto meta = g_fxo->get<lv2_fs_metadata_cache>().get(vpath, mp, true);
+
+	if (meta->local_path.empty())
 	{
 		return {CELL_ENOTMOUNTED, path};
 	}
 
-	std::lock_guard lock(mp->mutex);
-
-	fs::stat_t info{};
-
-	if (!fs::stat(local_path, info))
+	switch (meta->error)
 	{
-		switch (auto error = fs::g_tls_error)
-		{
-		case fs::error::noent:
-		{
-			// Try to analyse split file (TODO)
-			u64 total_size = 0;
-
-			for (u32 i = 66601; i <= 66699; i++)
-			{
-				if (fs::stat(fmt::format("%s.%u", local_path, i), info) && !info.is_directory)
-				{
-					total_size += info.size;
-				}
-				else
-				{
-					break;
-				}
-			}
-
-			// Use attributes from the first fragment (consistently with sys_fs_open+fstat)
-			if (fs::stat(local_path + ".66600", info) && !info.is_directory)
-			{
-				// Success
-				info.size += total_size;
-				break;
-			}
-
-			return {CELL_ENOENT, path};
-		}
-		default:
-		{
-			sys_fs.error("sys_fs_stat(): unknown error %s", error);
-			return {CELL_EIO, path};
-		}
-		}
+	case fs::error::ok: break;
+	case fs::error::noent: return {CELL_ENOENT, path};
+	default:
+	{
+		sys_fs.error("sys_fs_stat(): unknown error %s", meta->error);
+		return {CELL_EIO, path};
+	}
 	}
 
+	const fs::stat_t& info = meta->info;
+
 	sb->mode = info.is_directory ? CELL_FS_S_IFDIR | 0777 : CELL_FS_S_IFREG | 0666;
 	sb->uid = mp->flags & lv2_mp_flag::no_uid_gid ? -1 : 0;
 	sb->gid = mp->flags & lv2_mp_flag::no_uid_gid ? -1 : 0;
@@ -1669,7 +1810,7 @@ error_code sys_fs_fcntl(ppu_thread& ppu, u32 fd, u32 op, vm::ptr<void> _arg, u32
 			sys_fs.error("%s type: Writing %u bytes to FD=%d (path=%s)", file->type, arg->size, file->name.data());
 		}
 
-		std::lock_guard lock(file->mp->mutex);
+		std::unique_lock lock(file->mp->mutex);
 
 		if (!file->file)
 		{
@@ -1686,14 +1827,17 @@ error_code sys_fs_fcntl(ppu_thread& ppu, u32 fd, u32 op, vm::ptr<void> _arg, u32
 			return CELL_EBUSY;
 		}
 
-		const u64 old_pos = file->file.pos();
-		file->file.seek(arg->offset);
+		// Host files are accessed without holding the mount point lock, so that requests on other files (or other offsets) can proceed in parallel
+		reader_lock io_lock(file->io_mutex);
 
-		arg->out_size = op == 0x8000000a
-			? file->op_read(arg->buf, arg->size)
-			: file->op_write(arg->buf, arg->size);
+		if (file->is_native())
+		{
+			lock.unlock();
+		}
 
-		ensure(old_pos == file->file.seek(old_pos));
+		arg->out_size = op == 0x8000000a
+			? lv2_file::op_read(file->file, arg->offset, arg->buf, arg->size)
+			: lv2_file::op_write(file->file, arg->offset, arg->buf, arg->size);
 
 		// TODO: EDATA corruption detection
 
@@ -3,9 +3,12 @@
 #include "Emu/Memory/vm_ptr.h"
 #include "Emu/Cell/ErrorCodes.h"
 #include "Utilities/File.h"
+#include "Utilities/mutex.h"
 
 #include <string>
 #include <mutex>
+#include <memory>
+#include <unordered_map>
 
 // Open Flags
 enum : s32
@@ -155,6 +158,39 @@ struct lv2_fs_mount_point
 	mutable std::recursive_mutex mutex;
 };
 
+// Resolved virtual path and attributes of the host file
+struct lv2_fs_metadata
+{
+	std::string local_path; // Host path (empty if not mounted)
+	std::string ppath; // Processed virtual path
+	std::vector<std::string> ext; // Mount points inside the directory
+	bool has_info = false; // Whether the host file was looked up
+	fs::error error = fs::error::ok; // Lookup error (noent for missing files)
+	fs::stat_t info{};
+};
+
+// Positive and negative path lookup cache for read-only mount points, cleared when the VFS is remounted
+struct lv2_fs_metadata_cache
+{
+	static constexpr usz max_entries = 0x10000;
+
+	shared_mutex mutex;
+	std::unordered_map<std::string, std::shared_ptr<const lv2_fs_metadata>> entries;
+
+	atomic_t<u64> hits = 0;
+	atomic_t<u64> misses = 0;
+
+	lv2_fs_metadata_cache() = default;
+	lv2_fs_metadata_cache(const lv2_fs_metadata_cache&) = delete;
+	lv2_fs_metadata_cache& operator=(const lv2_fs_metadata_cache&) = delete;
+	~lv2_fs_metadata_cache();
+
+	// Resolve the path, the host file is always looked up on cached mount points and otherwise only if need_info is set
+	std::shared_ptr<const lv2_fs_metadata> get(std::string_view vpath, const lv2_fs_mount_point* mp, bool need_info);
+
+	void clear();
+};
+
 extern lv2_fs_mount_point g_mp_sys_dev_hdd0;
 extern lv2_fs_mount_point g_mp_sys_dev_hdd1;
 
@@ -220,6 +256,9 @@ struct lv2_file final : lv2_fs_object
 	// Stream lock
 	atomic_t<u32> lock{0};
 
+	// Held (shared) by positional reads and writes running outside of the mount point lock, the host file may only be closed or replaced while holding it exclusively
+	mutable shared_mutex io_mutex;
+
 	// Some variables for convinience of data restoration
 	struct save_restore_t
 	{
@@ -267,7 +306,7 @@ struct lv2_file final : lv2_fs_object
 	};
 
 	// Open a file with wrapped logic of sys_fs_open
-	static open_raw_result_t open_raw(const std::string& path, s32 flags, s32 mode, lv2_file_type type = lv2_file_type::regular, const lv2_fs_mount_point* mp = nullptr);
+	static open_raw_result_t open_raw(const std::string& path, s32 flags, s32 mode, lv2_file_type type = lv2_file_type::regular, const lv2_fs_mount_point* mp = nullptr, const lv2_fs_metadata* meta = nullptr);
 	static open_result_t open(std::string_view vpath, s32 flags, s32 mode, const void* arg = {}, u64 size = 0);
 
 	// File reading with intermediate buffer
@@ -286,6 +325,16 @@ struct lv2_file final : lv2_fs_object
 		return op_write(file, buf, size);
 	}
 
+	// Positional variants, the file position is not used or modified
+	static u64 op_read(const fs::file& file, u64 offset, vm::ptr<void> buf, u64 size);
+	static u64 op_write(const fs::file& file, u64 offset, vm::cptr<void> buf, u64 size);
+
+	// Whether positional operations on the file are thread-safe (host files only, not decrypted or views)
+	bool is_native() const
+	{
+		return file && file.get_handle() != fs::file{}.get_handle();
+	}
+
 	// For MSELF support
 	struct file_view;
 
@@ -12,6 +12,29 @@ PadHandlerBase::PadHandlerBase(pad_handler type) : m_type(type)
 {
 }
 
+u64 PadHandlerBase::get_input_timestamp()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Cheap digest of the current button and stick values, used to detect input changes for the latency measurement
+static u64 get_pad_state_digest(const Pad& pad)
+{
+	u64 digest = 0;
+
+	for (const Button& button : pad.m_buttons)
+	{
+		digest = (digest * 31) ^ (button.m_value | (u64{button.m_pressed} << 16));
+	}
+
+	for (const AnalogStick& stick : pad.m_sticks)
+	{
+		digest = (digest * 31) ^ stick.m_value;
+	}
+
+	return digest;
+}
+
 // Search an unordered map for a string value and return found keycode
 int PadHandlerBase::FindKeyCode(const std::unordered_map<u32, std::string>& map, const cfg::string& name, bool fallback)
 {
@@ -683,7 +706,16 @@ void PadHandlerBase::ThreadProc()
 			break;
 		}
 
+		const u64 old_digest = get_pad_state_digest(*pad);
+
 		get_mapping(device, pad);
+
+		// Handlers with their own event timestamps (evdev) have already stamped the pad at this point
+		if (get_pad_state_digest(*pad) != old_digest)
+		{
+			pad->stamp_input(get_input_timestamp());
+		}
+
 		get_extended_info(device, pad);
 		apply_pad_data(device, pad);
 	}
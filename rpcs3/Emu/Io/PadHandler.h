@@ -170,6 +170,10 @@ public:
 	virtual std::vector<std::string> ListDevices() = 0;
 	// Callback called during pad_thread::ThreadFunc
 	virtual void ThreadProc();
+	// Blocks until one of the bound devices has pending input or the timeout expired. Returns false if the handler can't wait on device events.
+	virtual bool wait_for_input(u64 /*timeout_us*/) { return false; }
+	// Current host time in microseconds, on the same clock as Pad::m_input_timestamp
+	static u64 get_input_timestamp();
 	// Binds a Pad to a device
 	virtual bool bindPadToDevice(std::shared_ptr<Pad> pad, const std::string& device, u8 player_id);
 	virtual void init_config(cfg_pad* /*cfg*/) = 0;
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "util/types.hpp"
+#include "util/atomic.hpp"
 #include "Emu/Io/pad_config_types.h"
 
+#include <algorithm>
 #include <vector>
 
 enum SystemInfo
@@ -249,6 +251,30 @@ struct VibrateMotor
 	{}
 };
 
+// Input-to-cellPad latency statistics (microseconds)
+struct pad_latency_stats
+{
+	u64 last = 0;
+	u64 min = umax;
+	u64 max = 0;
+	u64 total = 0;
+	u64 samples = 0;
+
+	void add_sample(u64 latency)
+	{
+		last = latency;
+		min = std::min(min, latency);
+		max = std::max(max, latency);
+		total += latency;
+		samples++;
+	}
+
+	u64 average() const
+	{
+		return samples ? total / samples : 0;
+	}
+};
+
 struct Pad
 {
 	const pad_handler m_pad_handler;
@@ -311,6 +337,16 @@ struct Pad
 	bool ldd{false};
 	u8 ldd_data[132] = {};
 
+	// Host timestamp (steady clock, microseconds) of the oldest input change not yet consumed by cellPadGetData. 0 if none.
+	atomic_t<u64> m_input_timestamp{0};
+	pad_latency_stats m_latency{};
+
+	// Records the time of an input change unless an older unconsumed one is already pending
+	void stamp_input(u64 timestamp)
+	{
+		m_input_timestamp.compare_and_swap(0, timestamp);
+	}
+
 	explicit Pad(pad_handler handler, u32 port_status, u32 device_capability, u32 device_type)
 		: m_pad_handler(handler)
 		, m_port_status(port_status)
@@ -7,6 +7,8 @@
 #include "Utilities/mutex.h"
 #include "Utilities/Thread.h"
 #include "Utilities/address_range.h"
+#include "Utilities/File.h"
+#include "Utilities/StrUtil.h"
 #include "Utilities/JIT.h"
 #include "Emu/CPU/CPUThread.h"
 #include "Emu/RSX/RSXThread.h"
@@ -613,6 +615,23 @@ namespace vm
 		thread_ctrl::emergency_exit("vm::reservation_escape");
 	}
 
+	// Shared memory views replace the reservation, so the advice has to be repeated for every mapping
+	// The kernel only uses huge pages where the mapping is congruent to the shared memory offset (views are mapped from offset 0)
+	static void _advise_huge_pages(u32 addr, u32 size)
+	{
+		if (g_cfg.core.huge_pages && addr % 0x200000 == 0)
+		{
+			utils::memory_advise_huge(g_base_addr + addr, size);
+			utils::memory_advise_huge(g_sudo_addr + addr, size);
+		}
+	}
+
+	// Preallocated blocks are extended down to a 2 MiB boundary so that the whole block can be advised (main memory starts at 0x10000)
+	static u32 _common_pad(u32 addr)
+	{
+		return g_cfg.core.huge_pages ? addr % 0x200000 : 0;
+	}
+
 	static void _page_map(u32 addr, u8 flags, u32 size, utils::shm* shm, u64 bflags, std::pair<const u32, std::pair<u32, std::shared_ptr<utils::shm>>>* (*search_shm)(vm::block_t* block, utils::shm* shm))
 	{
 		perf_meter<"PAGE_MAP"_u64> perf0;
@@ -727,6 +746,10 @@ namespace vm
 		{
 			fmt::throw_exception("Memory mapping failed (addr=0x%x, size=0x%x, flags=0x%x): %s", addr, size, flags, map_error);
 		}
+		else
+		{
+			_advise_huge_pages(addr, size);
+		}
 
 		if (flags & page_executable && !is_noop)
 		{
@@ -1179,12 +1202,20 @@ namespace vm
 			};
 
 			// Special path for whole-allocated areas allowing 4k granularity
-			m_common = std::make_shared<utils::shm>(size);
+			m_common_pad = _common_pad(addr);
+			m_common = std::make_shared<utils::shm>(size + m_common_pad);
 
-			if (!map_critical(vm::_ptr<u8>(addr), this->flags & page_size_4k && utils::c_page_size > 4096 ? utils::protection::rw : utils::protection::no) || !map_critical(vm::get_super_ptr(addr), utils::protection::rw))
+			if (!map_critical(vm::_ptr<u8>(addr - m_common_pad), this->flags & page_size_4k && utils::c_page_size > 4096 ? utils::protection::rw : utils::protection::no) || !map_critical(vm::get_super_ptr(addr - m_common_pad), utils::protection::rw))
 			{
 				fmt::throw_exception("Memory mapping failed (addr=0x%x, size=0x%x, flags=0x%x): %s", addr, size, flags, map_error);
 			}
+
+			if (m_common_pad)
+			{
+				utils::memory_protect(vm::base(addr - m_common_pad), m_common_pad, utils::protection::no);
+			}
+
+			_advise_huge_pages(addr - m_common_pad, size + m_common_pad);
 		}
 	}
 
@@ -1205,9 +1236,9 @@ namespace vm
 
 			if (m_common)
 			{
-				m_common->unmap_critical(vm::base(addr));
+				m_common->unmap_critical(vm::base(addr - m_common_pad));
 #ifdef _WIN32
-				m_common->unmap_critical(vm::get_super_ptr(addr));
+				m_common->unmap_critical(vm::get_super_ptr(addr - m_common_pad));
 #endif
 			}
 
@@ -1596,9 +1627,11 @@ namespace vm
 	{
 		if (flags & preallocated)
 		{
-			m_common = std::make_shared<utils::shm>(size);
-			m_common->map_critical(vm::base(addr), utils::protection::no);
-			m_common->map_critical(vm::get_super_ptr(addr));
+			m_common_pad = _common_pad(addr);
+			m_common = std::make_shared<utils::shm>(size + m_common_pad);
+			m_common->map_critical(vm::base(addr - m_common_pad), utils::protection::no);
+			m_common->map_critical(vm::get_super_ptr(addr - m_common_pad));
+			_advise_huge_pages(addr - m_common_pad, size + m_common_pad);
 			lock_sudo(addr, size);
 		}
 
@@ -1947,6 +1980,24 @@ namespace vm
 
 			std::memset(&g_pages, 0, sizeof(g_pages));
 
+#ifdef __linux__
+			if (g_cfg.core.huge_pages)
+			{
+				// Guest memory is shared memory, which the kernel only backs with huge pages if allowed explicitly (sysfs reports a bogus file size)
+				std::string shmem_thp(256, '\0');
+
+				if (const fs::file f{"/sys/kernel/mm/transparent_hugepage/shmem_enabled"})
+				{
+					shmem_thp.resize(f.read(shmem_thp.data(), shmem_thp.size()));
+				}
+
+				if (shmem_thp.find("[never]") != umax || shmem_thp.find("[deny]") != umax)
+				{
+					vm_log.warning("Huge pages requested but disabled for shared memory (shmem_enabled: %s). Set it to 'advise' to use them.", fmt::trim(shmem_thp, " \t\n"));
+				}
+			}
+#endif
+
 			g_locations =
 			{
 				std::make_shared<block_t>(0x00010000, 0x1FFF0000, page_size_64k | preallocated), // main
@@ -125,6 +125,9 @@ namespace vm
 		// Common mapped region for special cases
 		std::shared_ptr<utils::shm> m_common;
 
+		// Inaccessible guest memory mapped before addr by m_common, so that it's congruent to 2 MiB pages (huge pages)
+		u32 m_common_pad = 0;
+
 		atomic_t<u64> m_id = 0;
 
 		bool try_alloc(u32 addr, u64 bflags, u32 size, std::shared_ptr<utils::shm>&&) const;
@@ -2,6 +2,7 @@
 #include "BufferUtils.h"
 #include "../rsx_methods.h"
 #include "../RSXThread.h"
+#include "../RSXOffload.h"
 
 #include "util/to_endian.hpp"
 #include "util/sysinfo.hpp"
@@ -801,6 +802,39 @@ namespace
 		}
 	}
 
+	// Large index buffers are split between the upload workers when every input index produces exactly one output index
+	template<typename T>
+	std::tuple<T, T, u32> upload_untouched_split(std::span<to_be_t<const T>> src, std::span<T> dst, rsx::primitive_type draw_mode, bool is_primitive_restart_enabled, u32 primitive_restart_index)
+	{
+		if (is_primitive_restart_enabled && is_primitive_disjointed(draw_mode) && (std::is_same<T, u32>::value || primitive_restart_index <= 0xffff))
+		{
+			// Restart indices are dropped, the output offset of each index depends on all previous ones
+			return upload_untouched<T>(src, dst, draw_mode, is_primitive_restart_enabled, primitive_restart_index);
+		}
+
+		std::array<std::tuple<T, T, u32>, rsx::upload_pool::max_chunks> results;
+		results.fill(std::make_tuple(index_limit<T>(), T{0}, 0u));
+
+		// Chunks are multiples of 64 indices to keep the destination aligned for the vector stores
+		rsx::upload_pool::run(rsx::upload_job::index_array, std::as_bytes(src), ::size32(src), 64, [&](u32 chunk, u32 begin, u32 end)
+		{
+			results[chunk] = upload_untouched<T>(src.subspan(begin, end - begin), dst.subspan(begin, end - begin), draw_mode, is_primitive_restart_enabled, primitive_restart_index);
+		});
+
+		T min_index = index_limit<T>();
+		T max_index = 0;
+		u32 written = 0;
+
+		for (const auto& [chunk_min, chunk_max, chunk_written] : results)
+		{
+			min_index = std::min(min_index, chunk_min);
+			max_index = std::max(max_index, chunk_max);
+			written += chunk_written;
+		}
+
+		return std::make_tuple(min_index, max_index, written);
+	}
+
 	template<typename T>
 	std::tuple<T, T, u32> expand_indexed_triangle_fan(std::span<to_be_t<const T>> src, std::span<T> dst, bool is_primitive_restart_enabled, u32 primitive_restart_index)
 	{
@@ -1022,7 +1056,7 @@ namespace
 	{
 		if (!expands(draw_mode)) [[likely]]
 		{
-			return upload_untouched<T>(src, dst, draw_mode, restart_index_enabled, restart_index);
+			return upload_untouched_split<T>(src, dst, draw_mode, restart_index_enabled, restart_index);
 		}
 
 		switch (draw_mode)
@@ -343,6 +343,9 @@ void GLGSRender::flip(const rsx::display_flip_info_t& info)
 		m_text_printer.print_text(cmd, 4, 144, width, height, fmt::format("Texture memory: %12dM", texture_memory_size));
 		m_text_printer.print_text(cmd, 4, 162, width, height, fmt::format("Flush requests: %12d  = %2d (%3d%%) hard faults, %2d unavoidable, %2d misprediction(s), %2d speculation(s)", num_flushes, num_misses, cache_miss_ratio, num_unavoidable, num_mispredict, num_speculate));
 		m_text_printer.print_text(cmd, 4, 180, width, height, fmt::format("Texture uploads: %15u (%u from CPU - %02u%%)", num_texture_upload, num_texture_upload_miss, texture_upload_miss_ratio));
+		m_text_printer.print_text(cmd, 4, 198, width, height, fmt::format("Texture data: %16uK", info.stats.textures_staged_bytes / 1024));
+		m_text_printer.print_text(cmd, 4, 216, width, height, fmt::format("ZCULL reports: %15u (%u forced syncs)", info.stats.zcull_reports, info.stats.zcull_forced_syncs));
+		m_text_printer.print_text(cmd, 4, 234, width, height, fmt::format("Memoized FIFO regions: %7u (%u methods skipped)", info.stats.fifo_memo_hits, info.stats.fifo_memo_methods));
 	}
 
 	if (gl::debug::g_vis_texture)
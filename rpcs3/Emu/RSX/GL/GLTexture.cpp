@@ -707,6 +707,7 @@ namespace gl
 			for (const rsx::subresource_layout& layout : input_layouts)
 			{
 				upload_texture_subresource(staging_buffer, layout, format, is_swizzled, caps);
+				rsx::get_current_renderer()->get_stats().textures_staged_bytes += layout.data.size_bytes();
 
 				switch (dst->get_target())
 				{
@@ -820,6 +821,7 @@ namespace gl
 
 				caps.supports_hw_deswizzle = (is_swizzled && use_compute_transform && image_linear_size > 4096);
 				auto op = upload_texture_subresource(dst_buffer, layout, format, is_swizzled, caps);
+				rsx::get_current_renderer()->get_stats().textures_staged_bytes += layout.data.size_bytes();
 
 				// Define upload region
 				coord3u region;
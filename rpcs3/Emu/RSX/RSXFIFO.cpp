@@ -19,10 +19,351 @@ namespace rsx
 {
 	namespace FIFO
 	{
+		// Returns true if the method run contains a command other units may be waiting for,
+		// or a transfer which writes IO or local memory (the command stream itself may be modified)
+		static bool is_sync_barrier(u32 cmd, u32 count)
+		{
+			const u32 reg = (cmd & 0xfffc) >> 2;
+			const u32 last = (cmd & RSX_METHOD_NON_INCREMENT_CMD_MASK) == RSX_METHOD_NON_INCREMENT_CMD ? reg : reg + count - 1;
+
+			static constexpr std::pair<u32, u32> barriers[] =
+			{
+				{NV406E_SET_REFERENCE, 1},
+				{NV406E_SEMAPHORE_ACQUIRE, 1},
+				{NV406E_SEMAPHORE_RELEASE, 1},
+				{NV4097_BACK_END_WRITE_SEMAPHORE_RELEASE, 1},
+				{NV4097_TEXTURE_READ_SEMAPHORE_RELEASE, 1},
+				{NV4097_GET_REPORT, 1},
+				{NV0039_BUFFER_NOTIFY, 1},
+				{NV3089_IMAGE_IN, 1},
+				{NV308A_COLOR, 0x700},
+			};
+
+			for (const auto& [barrier, size] : barriers)
+			{
+				if (barrier <= last && reg < barrier + size)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		// Walks the command stream ahead of GET and decodes method runs and flow control into a ring of batches
+		// Decoding stops at PUT, at sync barriers, at jumps to self, at memory which is not ready and at anything unexpected.
+		// The RSX thread then reads the next command itself and restarts the decoder after it (single producer, single consumer)
+		class FIFO_decoder
+		{
+			static constexpr u32 ring_size = 32;
+			static constexpr u32 no_return = umax;
+
+			struct request
+			{
+				u32 epoch;
+				u32 addr;
+				u32 active;
+				u32 reserved;
+			};
+
+			RsxDmaControl* const m_ctrl;
+			const rsx::rsx_iomap_table* const m_iotable;
+
+			const std::unique_ptr<command_batch[]> m_ring = std::make_unique<command_batch[]>(ring_size);
+
+			atomic_t<u32> m_head = 0; // Written by the decoder
+			atomic_t<u32> m_tail = 0; // Written by the RSX thread
+			atomic_t<request> m_request{};
+			atomic_t<u64> m_position = umax; // Epoch and address of the next command to decode (umax: inactive)
+			atomic_t<u32> m_full = 0; // Set while the decoder waits for the RSX thread to consume a batch
+
+			// RSX thread state
+			u32 m_epoch = 0;
+
+			// Decoder thread state
+			u32 m_line_addr = umax;
+			alignas(64) spu_rdata_t m_line;
+
+			// Read a command word, returns false if the memory is unavailable for now
+			bool fetch(u32 addr, u32& value)
+			{
+				if ((addr & -128) != m_line_addr)
+				{
+					const u32 addr1 = m_iotable->get_addr(addr & -128);
+
+					if (addr1 == umax)
+					{
+						return false;
+					}
+
+					const auto& res = vm::reservation_acquire(addr1);
+					const u64 time0 = res;
+
+					if (time0 & 127)
+					{
+						return false;
+					}
+
+					const auto& src = *vm::_ptr<spu_rdata_t>(addr1);
+					mov_rdata(m_line, src);
+
+					if (time0 != res || !cmp_rdata(m_line, src))
+					{
+						return false;
+					}
+
+					m_line_addr = addr & -128;
+				}
+
+				be_t<u32> ret;
+				std::memcpy(&ret, m_line + (addr & 127), sizeof(u32));
+				value = ret;
+				return true;
+			}
+
+			// Wake the decoder if it waits for a free batch (RSX thread)
+			void notify_consumed()
+			{
+				if (m_full)
+				{
+					m_tail.notify_one();
+				}
+			}
+
+			// Decode one command at pos, returns false if it can't be decoded now
+			bool decode(u32 epoch, u32& pos, u32& ret, bool& active)
+			{
+				const u32 put = m_ctrl->put & ~3;
+
+				if (pos == put)
+				{
+					return false;
+				}
+
+				u32 cmd = 0;
+
+				if (!fetch(pos, cmd))
+				{
+					return false;
+				}
+
+				command_batch& batch = m_ring[m_head % ring_size];
+				batch.epoch = epoch;
+				batch.addr = pos;
+				batch.cmd = cmd;
+				batch.count = 0;
+
+				if (cmd & RSX_METHOD_NON_METHOD_CMD_MASK)
+				{
+					if ((cmd & RSX_METHOD_OLD_JUMP_CMD_MASK) == RSX_METHOD_OLD_JUMP_CMD || (cmd & RSX_METHOD_NEW_JUMP_CMD_MASK) == RSX_METHOD_NEW_JUMP_CMD)
+					{
+						const u32 offs = cmd & ((cmd & RSX_METHOD_OLD_JUMP_CMD_MASK) == RSX_METHOD_OLD_JUMP_CMD ? RSX_METHOD_OLD_JUMP_OFFSET_MASK : RSX_METHOD_NEW_JUMP_OFFSET_MASK);
+
+						if (offs == pos)
+						{
+							// Jump to self, the RSX thread is going to spin here
+							active = false;
+							return false;
+						}
+
+						pos = offs;
+					}
+					else if ((cmd & RSX_METHOD_CALL_CMD_MASK) == RSX_METHOD_CALL_CMD && ret == no_return)
+					{
+						ret = pos + 4;
+						pos = cmd & RSX_METHOD_CALL_OFFSET_MASK;
+					}
+					else if ((cmd & RSX_METHOD_RETURN_MASK) == RSX_METHOD_RETURN_CMD && ret != no_return)
+					{
+						pos = std::exchange(ret, no_return);
+					}
+					else
+					{
+						// Nested call, return with unknown call stack or malformed command
+						active = false;
+						return false;
+					}
+
+					m_head++;
+					return true;
+				}
+
+				const u32 count = (cmd >> 18) & 0x7ff;
+
+				// Check that PUT is not in the middle of the arguments
+				if (count && put - (pos + 4) < count * 4)
+				{
+					return false;
+				}
+
+				for (u32 i = 0; i < count; i++)
+				{
+					if (!fetch(pos + 4 + i * 4, batch.args[i]))
+					{
+						return false;
+					}
+				}
+
+				batch.count = count;
+				pos += 4 + count * 4;
+				m_head++;
+
+				if (count && is_sync_barrier(cmd, count))
+				{
+					// Commands after it may depend on its result
+					active = false;
+				}
+
+				return true;
+			}
+
+		public:
+			FIFO_decoder(rsx::thread* pctrl)
+				: m_ctrl(pctrl->ctrl)
+				, m_iotable(&pctrl->iomap_table)
+			{
+			}
+
+			// Get the batch for the command at the specified address (RSX thread)
+			const command_batch* front(u32 addr)
+			{
+				for (u32 tail = m_tail; tail != m_head; tail = ++m_tail)
+				{
+					const command_batch& batch = m_ring[tail % ring_size];
+
+					if (batch.epoch != m_epoch)
+					{
+						// Discard batches decoded before the last restart
+						continue;
+					}
+
+					notify_consumed();
+					return batch.addr == addr ? &batch : nullptr;
+				}
+
+				notify_consumed();
+				return nullptr;
+			}
+
+			// Release the batch returned by front() (RSX thread)
+			void pop()
+			{
+				m_tail++;
+				notify_consumed();
+			}
+
+			// Discard the batches preceding the command at the specified address (RSX thread)
+			// Returns false if the address is neither decoded nor being decoded, in which case the decoder must be restarted
+			bool seek(u32 addr)
+			{
+				for (u32 tail = m_tail; tail != m_head; tail = ++m_tail)
+				{
+					const command_batch& batch = m_ring[tail % ring_size];
+
+					if (batch.epoch == m_epoch && batch.addr == addr)
+					{
+						notify_consumed();
+						return true;
+					}
+				}
+
+				notify_consumed();
+				return m_position == (u64{m_epoch} << 32 | addr);
+			}
+
+			// Discard all batches and start decoding at the specified address (RSX thread)
+			void restart(u32 addr, bool active = true)
+			{
+				m_request.release(request{++m_epoch, addr, active, 0});
+				m_request.notify_one();
+				notify_consumed();
+			}
+
+			void operator()()
+			{
+				request current{};
+				u32 pos = 0;
+				u32 ret = no_return;
+				bool active = false;
+
+				while (thread_ctrl::state() != thread_state::aborting)
+				{
+					if (const request req = m_request.load(); req.epoch != current.epoch)
+					{
+						current = req;
+						pos = req.addr;
+						ret = no_return;
+						active = req.active != 0;
+						m_line_addr = umax;
+					}
+
+					if (active && m_head - m_tail >= ring_size)
+					{
+						// Ring is full, wait for the RSX thread to consume a batch
+						m_position.release(u64{current.epoch} << 32 | pos);
+						m_full.release(1);
+
+						if (const u32 tail = m_tail; m_head - tail >= ring_size && m_request.load().epoch == current.epoch)
+						{
+							thread_ctrl::wait_on(m_tail, tail);
+						}
+
+						m_full.release(0);
+						continue;
+					}
+
+					if (active && decode(current.epoch, pos, ret, active))
+					{
+						m_position.release(active ? u64{current.epoch} << 32 | pos : umax);
+						continue;
+					}
+
+					// Nothing to decode until the RSX thread restarts the decoder (PUT reached, memory not ready or barrier)
+					// Memory which was not ready must be fetched again
+					active = false;
+					m_line_addr = umax;
+					m_position.release(umax);
+					thread_ctrl::wait_on(m_request, current);
+				}
+			}
+
+			static constexpr auto thread_name = "RSX FIFO Decoder"sv;
+		};
+
 		FIFO_control::FIFO_control(::rsx::thread* pctrl)
 		{
 			m_ctrl = pctrl->ctrl;
 			m_iotable = &pctrl->iomap_table;
+
+			if (g_cfg.core.rsx_fifo_accuracy && g_cfg.core.rsx_fifo_decoder)
+			{
+				m_decoder = std::make_unique<named_thread<FIFO_decoder>>(pctrl);
+			}
+		}
+
+		FIFO_control::~FIFO_control()
+		{
+		}
+
+		void FIFO_control::release_batch()
+		{
+			if (m_batch)
+			{
+				m_decoder->pop();
+				m_batch = nullptr;
+			}
+		}
+
+		void FIFO_control::invalidate_cache()
+		{
+			m_cache_size = 0;
+
+			if (m_decoder)
+			{
+				// Memory may have been modified, decoded commands are discarded and the remaining arguments are fetched again
+				release_batch();
+				m_decoder->restart(0, false);
+			}
 		}
 
 		void FIFO_control::sync_get() const
@@ -174,15 +515,23 @@ namespace rsx
 
 		void FIFO_control::set_get(u32 get, u32 spin_cmd)
 		{
-			invalidate_cache();
-
 			if (spin_cmd && m_ctrl->get == get)
 			{
+				invalidate_cache();
 				m_memwatch_addr = get;
 				m_memwatch_cmp = spin_cmd;
 				return;
 			}
 
+			m_cache_size = 0;
+
+			if (m_decoder)
+			{
+				// Flush all decoded commands, GET may be moved by a recovery or a reset
+				release_batch();
+				m_decoder->restart(get);
+			}
+
 			// Update ctrl registers
 			m_ctrl->get.release(m_internal_get = get);
 			m_remaining_commands = 0;
@@ -190,6 +539,13 @@ namespace rsx
 
 		std::span<const u32> FIFO_control::get_current_arg_ptr() const
 		{
+			if (m_batch)
+			{
+				// Arguments of the decoded command
+				const u32 index = (m_internal_get - m_batch->addr) / 4 - 1;
+				return {m_batch->args + index, m_batch->count - index};
+			}
+
 			if (g_cfg.core.rsx_fifo_accuracy)
 			{
 				// Return a pointer to the cache storage with confined access
@@ -210,7 +566,11 @@ namespace rsx
 				bool ok{};
 				u32 arg = 0;
 
-				if (g_cfg.core.rsx_fifo_accuracy)
+				if (m_batch)
+				{
+					arg = m_batch->args[(m_internal_get - m_batch->addr) / 4];
+				}
+				else if (g_cfg.core.rsx_fifo_accuracy)
 				{
 					std::tie(ok, arg) = fetch_u32(m_internal_get + 4);
 
@@ -300,6 +660,17 @@ namespace rsx
 				m_memwatch_cmp = 0;
 			}
 
+			if (m_decoder)
+			{
+				release_batch();
+
+				if (const auto batch = m_decoder->front(m_internal_get))
+				{
+					read_batch(*batch, data);
+					return;
+				}
+			}
+
 			if (!g_cfg.core.rsx_fifo_accuracy)
 			{
 				const u32 put = read_put();
@@ -354,6 +725,15 @@ namespace rsx
 			ensure(!m_remaining_commands);
 			const u32 count = (m_cmd >> 18) & 0x7ff;
 
+			if (m_decoder && (!count || !is_sync_barrier(m_cmd, count)))
+			{
+				// Decode the commands following this one, unless they are already decoded or being decoded
+				if (const u32 next = m_internal_get + 4 + count * 4; !m_decoder->seek(next))
+				{
+					m_decoder->restart(next);
+				}
+			}
+
 			if (!count)
 			{
 				m_ctrl->get.release(m_internal_get += 4);
@@ -410,6 +790,38 @@ namespace rsx
 			data.set(m_cmd & 0xfffc, vm::read32(m_args_ptr));
 		}
 
+		void FIFO_control::read_batch(const command_batch& batch, register_pair& data)
+		{
+			m_batch = &batch;
+			m_cmd = batch.cmd;
+
+			if (m_cmd & RSX_METHOD_NON_METHOD_CMD_MASK)
+			{
+				// Flow control, stop reading
+				data.reg = m_cmd;
+				return;
+			}
+
+			if (!batch.count)
+			{
+				release_batch();
+				m_ctrl->get.release(m_internal_get += 4);
+				data.reg = FIFO_NOP;
+				return;
+			}
+
+			if (batch.count > 1)
+			{
+				// Set up readback parameters
+				m_command_reg = m_cmd & 0xfffc;
+				m_command_inc = ((m_cmd & RSX_METHOD_NON_INCREMENT_CMD_MASK) == RSX_METHOD_NON_INCREMENT_CMD) ? 0 : 4;
+				m_remaining_commands = batch.count - 1;
+			}
+
+			m_internal_get += 4;
+			data.set(m_cmd & 0xfffc, batch.args[0]);
+		}
+
 		void flattening_helper::reset(bool _enabled)
 		{
 			enabled = _enabled;
@@ -572,6 +984,186 @@ namespace rsx
 
 			return NOTHING;
 		}
+
+		void memoization_helper::analyze(region& r, std::span<const be_t<u32>> data)
+		{
+			std::vector<register_pair> writes;
+			u32 pos = 0;
+			u32 num_methods = 0;
+
+			// Collect leading method runs which only update registers
+			while (pos < data.size())
+			{
+				const u32 cmd = data[pos];
+
+				if (cmd & RSX_METHOD_NON_METHOD_CMD_MASK)
+				{
+					// Flow control or malformed command
+					break;
+				}
+
+				const u32 count = (cmd >> 18) & 0x7ff;
+				const u32 reg = (cmd & 0xfffc) >> 2;
+				const u32 inc = (cmd & RSX_METHOD_NON_INCREMENT_CMD_MASK) == RSX_METHOD_NON_INCREMENT_CMD ? 0 : 1;
+
+				if (data.size() - pos - 1 < count)
+				{
+					// Incomplete
+					break;
+				}
+
+				bool has_handler = false;
+
+				for (u32 i = 0; i < count; i++)
+				{
+					if (reg + i * inc >= methods.size() || methods[reg + i * inc])
+					{
+						has_handler = true;
+						break;
+					}
+				}
+
+				if (has_handler)
+				{
+					break;
+				}
+
+				for (u32 i = 0; i < count; i++)
+				{
+					writes.push_back({reg + i * inc, data[pos + 1 + i]});
+				}
+
+				pos += 1 + count;
+				num_methods += count;
+			}
+
+			if (num_methods < min_region_methods)
+			{
+				r.length = 0;
+				return;
+			}
+
+			// Keep the last write of every register, the order does not matter without handlers
+			std::stable_sort(writes.begin(), writes.end(), [](const register_pair& a, const register_pair& b)
+			{
+				return a.reg < b.reg;
+			});
+
+			r.writes.clear();
+
+			for (usz i = 0; i < writes.size(); i++)
+			{
+				if (i + 1 == writes.size() || writes[i + 1].reg != writes[i].reg)
+				{
+					r.writes.push_back(writes[i]);
+				}
+			}
+
+			r.length = pos * 4;
+			r.methods = num_methods;
+			r.data.assign(data.begin(), data.begin() + pos);
+		}
+
+		bool memoization_helper::enter(thread* rsx, u32 start, bool in_begin_end)
+		{
+			if (m_regions.size() >= 0x1000 && !m_regions.contains(start))
+			{
+				m_regions.clear();
+			}
+
+			region& r = m_regions[start];
+
+			// Only look at commands which have been submitted, and stay inside the IO page to keep the mapping contiguous
+			const u32 put = rsx->fifo_ctrl->read_put<false>();
+			const u32 size = put < start ? 0 : std::min({put - start, max_region_size, 0x100000 - (start & 0xfffff)}) / 4;
+			const u32 addr = rsx->iomap_table.get_addr(start);
+
+			if (addr == umax)
+			{
+				return false;
+			}
+
+			const auto data = vm::_ptr<const be_t<u32>>(addr);
+
+			// Reservation times of the cache lines, which change on writes by the SPU, by DMA and by reservation stores
+			const auto get_res_times = [&](u32 length, std::vector<u64>& out)
+			{
+				out.clear();
+
+				for (u32 line = addr & -128; line < addr + length; line += 128)
+				{
+					out.push_back(vm::reservation_acquire(line));
+				}
+			};
+
+			if (r.length)
+			{
+				if (size * 4 < r.length)
+				{
+					// Not fully submitted yet
+					return false;
+				}
+
+				if (r.in_begin_end != in_begin_end)
+				{
+					// Different state inputs, keep the recording for later visits
+					return false;
+				}
+
+				thread_local std::vector<u64> res_times;
+				get_res_times(r.length, res_times);
+
+				// Plain stores don't update the reservation times, so the commands are compared too if the lines weren't written otherwise
+				if (r.addr == addr && res_times == r.res_times && std::memcmp(data, r.data.data(), r.length) == 0)
+				{
+					for (const register_pair& write : r.writes)
+					{
+						method_registers.decode(write.reg, write.value);
+					}
+
+					rsx->fifo_ctrl->set_get(start + r.length);
+
+					auto& stats = rsx->get_stats();
+					stats.fifo_memo_hits++;
+					stats.fifo_memo_methods += r.methods;
+					return true;
+				}
+
+				// The commands have changed since the last visit, back off in case they change every frame
+				r.length = 0;
+				r.visits = 1;
+				r.data.clear();
+				return false;
+			}
+
+			if (r.visits++ % 64)
+			{
+				// Recently found not worth memoizing, check again later
+				return false;
+			}
+
+			// Copy the commands out so the recording matches what is parsed
+			get_res_times(size * 4, r.res_times);
+			const std::vector<be_t<u32>> copy(data, data + size);
+			analyze(r, copy);
+
+			if (r.length)
+			{
+				r.addr = addr;
+				r.in_begin_end = in_begin_end;
+				r.res_times.resize(utils::aligned_div((addr & 127) + r.length, 128));
+			}
+
+			return false;
+		}
+	}
+
+	void thread::memoize_region(u32 start)
+	{
+		if (g_cfg.video.fifo_memoization && !capture_current_frame && !m_flattener.is_enabled()) [[unlikely]]
+		{
+			m_memoizer.enter(this, start, in_begin_end);
+		}
 	}
 
 	void thread::run_FIFO()
@@ -629,7 +1221,9 @@ namespace rsx
 				.any())
 			{
 				const u32 offs = cmd & (jump_type.test(0) ? RSX_METHOD_OLD_JUMP_OFFSET_MASK : RSX_METHOD_NEW_JUMP_OFFSET_MASK);
-				if (offs == fifo_ctrl->get_pos())
+				const bool jump_to_self = offs == fifo_ctrl->get_pos();
+
+				if (jump_to_self)
 				{
 					//Jump to self. Often preceded by NOP
 					if (performance_counters.state == FIFO_state::running)
@@ -647,6 +1241,12 @@ namespace rsx
 
 				//rsx_log.warning("rsx jump(0x%x) #addr=0x%x, cmd=0x%x, get=0x%x, put=0x%x", offs, m_ioAddress + get, cmd, get, put);
 				fifo_ctrl->set_get(offs, cmd);
+
+				if (!jump_to_self)
+				{
+					memoize_region(offs);
+				}
+
 				return;
 			}
 			if ((cmd & RSX_METHOD_CALL_CMD_MASK) == RSX_METHOD_CALL_CMD)
@@ -663,6 +1263,7 @@ namespace rsx
 				fifo_ret_addr = fifo_ctrl->get_pos() + 4;
 				fifo_ctrl->set_get(offs);
 				last_known_code_start = offs;
+				memoize_region(offs);
 				return;
 			}
 			if ((cmd & RSX_METHOD_RETURN_MASK) == RSX_METHOD_RETURN_CMD)
@@ -676,6 +1277,7 @@ namespace rsx
 
 				fifo_ctrl->set_get(std::exchange(fifo_ret_addr, RSX_CALL_STACK_EMPTY));
 				last_known_code_start = ctrl->get;
+				memoize_region(last_known_code_start);
 				return;
 			}
 
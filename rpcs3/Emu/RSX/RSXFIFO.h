@@ -3,7 +3,13 @@
 #include "util/types.hpp"
 #include "Emu/RSX/gcm_enums.h"
 
+#include <memory>
 #include <span>
+#include <unordered_map>
+#include <vector>
+
+template <class Context>
+class named_thread;
 
 struct RsxDmaControl;
 
@@ -110,6 +116,47 @@ namespace rsx
 			inline flatten_op test(register_pair& command);
 		};
 
+		// Replays the register writes at the start of a command region (jump/call/return target) if the same commands were seen on an earlier visit.
+		// Only methods without handlers are memoized, so the result only depends on the command words and the begin/end state.
+		class memoization_helper
+		{
+			struct region
+			{
+				u32 length = 0;  // Length in bytes of the memoized commands, 0 if the region is not worth memoizing
+				u32 methods = 0; // Number of methods replaced by the replay
+				u32 visits = 0;
+				u32 addr = 0; // Guest address of the commands
+				bool in_begin_end = false; // State input: whether the commands were recorded inside a draw
+				std::vector<be_t<u32>> data; // Recorded commands
+				std::vector<u64> res_times; // Reservation times of the cache lines of the commands
+				std::vector<register_pair> writes; // Final value of every register written
+			};
+
+			// Limits of a memoized region (a visit costs a comparison of up to max_region_size bytes)
+			static constexpr u32 max_region_size = 0x1000;
+			static constexpr u32 min_region_methods = 16;
+
+			std::unordered_map<u32, region> m_regions;
+
+			void analyze(region& r, std::span<const be_t<u32>> data);
+
+		public:
+			// Called after flow control moved GET to 'start'. Returns true if commands were replayed and GET was advanced.
+			bool enter(thread* rsx, u32 start, bool in_begin_end);
+		};
+
+		// Command decoded ahead of GET by the FIFO decoder thread
+		struct command_batch
+		{
+			u32 epoch;
+			u32 addr;  // Address of the command header
+			u32 cmd;   // Command header
+			u32 count; // Number of arguments, 0 for NOP and flow control
+			u32 args[0x7ff];
+		};
+
+		class FIFO_decoder;
+
 		class FIFO_control
 		{
 		private:
@@ -129,12 +176,20 @@ namespace rsx
 			u32 m_cache_addr = 0;
 			u32 m_cache_size = 0;
 			alignas(64) std::byte m_cache[8][128];
+
+			// Optional decoder thread and the batch of the current command
+			std::unique_ptr<named_thread<FIFO_decoder>> m_decoder;
+			const command_batch* m_batch = nullptr;
+
+			void release_batch();
+			void read_batch(const command_batch& batch, register_pair& data);
+
 		public:
 			FIFO_control(rsx::thread* pctrl);
-			~FIFO_control() = default;
+			~FIFO_control();
 
 			std::pair<bool, u32> fetch_u32(u32 addr);
-			void invalidate_cache() { m_cache_size = 0; }
+			void invalidate_cache();
 
 			u32 get_pos() const { return m_internal_get; }
 			u32 last_cmd() const { return m_cmd; }
@@ -5,7 +5,9 @@
 #include "RSXThread.h"
 
 #include <thread>
+#include <chrono>
 #include "util/asm.hpp"
+#include "util/sysinfo.hpp"
 
 namespace rsx
 {
@@ -110,10 +112,17 @@ namespace rsx
 
 	void dma_manager::copy(void *dst, void *src, u32 length) const
 	{
-		if (length <= max_immediate_transfer_size || !g_cfg.video.multithreaded_rsx)
+		if (length <= max_immediate_transfer_size)
 		{
 			std::memcpy(dst, src, length);
 		}
+		else if (!g_cfg.video.multithreaded_rsx)
+		{
+			upload_pool::run(upload_job::vertex_copy, { static_cast<const std::byte*>(src), length }, length, 4096, [&](u32, u32 begin, u32 end)
+			{
+				std::memcpy(static_cast<u8*>(dst) + begin, static_cast<const u8*>(src) + begin, end - begin);
+			});
+		}
 		else
 		{
 			g_fxo->get<dma_thread>().m_enqueued_count++;
@@ -235,4 +244,175 @@ namespace rsx
 
 		return utils::address_range::start_length(vm::get_addr(address), range);
 	}
+
+	struct upload_pool::shared_state
+	{
+		struct tuner
+		{
+			u32 threshold;
+			const u32 min_threshold;
+			u32 jobs = 0;
+			u32 serial_runs = 0;
+			f64 serial_cost = 0.; // Average nanoseconds per element of the jobs which ran inline
+		};
+
+		static constexpr u32 min_thresholds[2]{ 0x4000, 0x10000 };
+
+		std::mutex mutex;
+		std::array<tuner, 2> tuners{ tuner{ 0x20000, min_thresholds[0] }, tuner{ 0x100000, min_thresholds[1] } };
+
+		// Current job. Only valid while the job has unfinished chunks, which is guaranteed after claiming one.
+		job_func func = nullptr;
+		const void* ctx = nullptr;
+		u32 count = 0;
+		u32 chunk_size = 0;
+
+		// Upper 32 bits: job sequence number, lower 32 bits: number of unclaimed chunks
+		atomic_t<u64> cursor = 0;
+		atomic_t<u32> finished = 0;
+		atomic_t<u32> signal = 0;
+
+		std::unique_ptr<named_thread_group<pool_thread>> workers;
+
+		// Claims and runs chunks of the given job until none are left
+		void process(u32 seq)
+		{
+			while (true)
+			{
+				const u64 old = cursor.load();
+
+				if (static_cast<u32>(old >> 32) != seq || !static_cast<u32>(old))
+				{
+					return;
+				}
+
+				if (!cursor.compare_and_swap_test(old, old - 1))
+				{
+					continue;
+				}
+
+				const u32 chunk = static_cast<u32>(old) - 1;
+				const u32 begin = chunk * chunk_size;
+				func(ctx, chunk, begin, std::min(begin + chunk_size, count));
+				finished++;
+			}
+		}
+
+		static constexpr u32 max_threshold = 0x1000000;
+	};
+
+	struct upload_pool::pool_thread
+	{
+		shared_state* state;
+
+		void operator()() const
+		{
+			if (g_cfg.core.thread_scheduler != thread_scheduler_mode::os)
+			{
+				thread_ctrl::set_thread_affinity_mask(thread_ctrl::get_affinity_mask(thread_class::rsx));
+			}
+
+			for (u32 seen = state->signal; thread_ctrl::state() != thread_state::aborting;)
+			{
+				thread_ctrl::wait_on(state->signal, seen);
+				seen = state->signal;
+				state->process(seen);
+			}
+		}
+	};
+
+	bool upload_pool::can_split(upload_job kind, u32 count, u32 granularity)
+	{
+		// Small hosts always run inline
+		return g_cfg.video.parallel_vertex_upload && utils::get_thread_count() >= 4 && count >= granularity * 2 && count >= shared_state::min_thresholds[static_cast<u32>(kind)] / 4;
+	}
+
+	void upload_pool::run_split(upload_job kind, std::span<const std::byte> src, u32 count, u32 granularity, job_func func, const void* ctx)
+	{
+		auto& pool = g_fxo->get<shared_state>();
+
+		// Only one job can be split at a time, other callers run inline
+		std::unique_lock lock(pool.mutex, std::try_to_lock);
+
+		auto& tuner = pool.tuners[static_cast<u32>(kind)];
+
+		if (!lock || count < tuner.threshold / 4)
+		{
+			func(ctx, 0, 0, count);
+			return;
+		}
+
+		// Keep sampling the inline cost of large jobs, the cost of the parallel path is only meaningful relative to it
+		const bool inline_run = count < tuner.threshold || !tuner.serial_cost || ++tuner.jobs % 32 == 0;
+		const auto start = std::chrono::steady_clock::now();
+
+		if (inline_run)
+		{
+			func(ctx, 0, 0, count);
+
+			const f64 cost = static_cast<f64>((std::chrono::steady_clock::now() - start).count()) / count;
+			tuner.serial_cost = tuner.serial_cost ? tuner.serial_cost * 0.75 + cost * 0.25 : cost;
+
+			// Retry splitting smaller jobs from time to time in case the previous measurements were disturbed
+			if (++tuner.serial_runs % 256 == 0 && tuner.threshold > tuner.min_threshold)
+			{
+				tuner.threshold /= 2;
+			}
+
+			return;
+		}
+
+		if (!pool.workers)
+		{
+			const u32 worker_count = std::min<u32>(utils::get_thread_count() / 2 - 1, 3);
+			pool.workers = std::make_unique<named_thread_group<pool_thread>>("RSX Upload ", worker_count, pool_thread{ &pool });
+		}
+
+		// Fault in protected guest pages on this thread, the workers must not raise access violations
+		for (usz offset = 0; offset < src.size(); offset += 4096)
+		{
+			static_cast<void>(*static_cast<const volatile std::byte*>(&src[offset]));
+		}
+
+		if (!src.empty())
+		{
+			static_cast<void>(*static_cast<const volatile std::byte*>(&src.back()));
+		}
+
+		const u32 target_chunks = std::min<u32>((pool.workers->size() + 1) * 4, max_chunks);
+		const u32 chunk_size = utils::align(utils::aligned_div(count, target_chunks), granularity);
+		const u32 chunks = utils::aligned_div(count, chunk_size);
+		const u32 seq = pool.signal + 1;
+
+		pool.func = func;
+		pool.ctx = ctx;
+		pool.count = count;
+		pool.chunk_size = chunk_size;
+		pool.finished.release(0);
+		pool.cursor.release((u64{seq} << 32) | chunks);
+
+		pool.signal.release(seq);
+		pool.signal.notify_all();
+
+		pool.process(seq);
+
+		while (pool.finished < chunks)
+		{
+			utils::pause();
+		}
+
+		const f64 cost = static_cast<f64>((std::chrono::steady_clock::now() - start).count()) / count;
+
+		if (cost * 1.25 > tuner.serial_cost && tuner.threshold < shared_state::max_threshold)
+		{
+			// Not worth waking up the workers at this size
+			tuner.threshold *= 2;
+			rsx_log.trace("Upload split threshold for job %u raised to %u (%.3fns/element, serial %.3fns/element)", static_cast<u32>(kind), tuner.threshold, cost, tuner.serial_cost);
+		}
+		else if (cost * 2 < tuner.serial_cost && tuner.threshold > tuner.min_threshold)
+		{
+			tuner.threshold /= 2;
+			rsx_log.trace("Upload split threshold for job %u lowered to %u (%.3fns/element, serial %.3fns/element)", static_cast<u32>(kind), tuner.threshold, cost, tuner.serial_cost);
+		}
+	}
 }
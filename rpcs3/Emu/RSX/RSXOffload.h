@@ -4,6 +4,7 @@
 #include "Utilities/address_range.h"
 #include "gcm_enums.h"
 
+#include <span>
 #include <vector>
 
 namespace rsx
@@ -81,4 +82,48 @@ namespace rsx
 
 		struct offload_thread;
 	};
+
+	enum class upload_job : u32
+	{
+		index_array = 0,
+		vertex_copy = 1,
+	};
+
+	// Splits large vertex and index uploads between the calling thread and a small pool of worker threads.
+	// Jobs smaller than the split threshold run inline; the threshold of each kind of job is tuned at runtime
+	// by comparing the measured cost per element of serial and parallel runs.
+	class upload_pool
+	{
+	public:
+		static constexpr u32 max_chunks = 32;
+
+		// Processes [0, count) as func(chunk, begin, end) with chunk < max_chunks. Every range except the last one is a multiple of granularity.
+		// src is the guest memory read by the job. It is touched on the calling thread before the workers start, so that access violations
+		// on protected pages are handled by the caller and never by a worker the caller is waiting on.
+		template <typename F>
+		static void run(upload_job kind, std::span<const std::byte> src, u32 count, u32 granularity, const F& func)
+		{
+			if (!can_split(kind, count, granularity))
+			{
+				func(0, 0, count);
+				return;
+			}
+
+			run_split(kind, src, count, granularity, [](const void* func, u32 chunk, u32 begin, u32 end)
+			{
+				(*static_cast<const F*>(func))(chunk, begin, end);
+			}, &func);
+		}
+
+		struct pool_thread;
+		struct shared_state;
+
+	private:
+		using job_func = void(*)(const void* func, u32 chunk, u32 begin, u32 end);
+
+		// Returns false if the job is too small to ever be split
+		static bool can_split(upload_job kind, u32 count, u32 granularity);
+
+		static void run_split(upload_job kind, std::span<const std::byte> src, u32 count, u32 granularity, job_func func, const void* ctx);
+	};
 }
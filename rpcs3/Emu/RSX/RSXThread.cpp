@@ -16,6 +16,7 @@
 #include "Emu/Cell/lv2/sys_event.h"
 #include "Emu/Cell/lv2/sys_time.h"
 #include "Emu/Cell/Modules/cellGcmSys.h"
+#include "Emu/perf_tuner.hpp"
 #include "Overlays/overlay_perf_metrics.h"
 #include "Program/GLSLCommon.h"
 #include "Utilities/date_time.h"
@@ -2625,6 +2626,11 @@ namespace rsx
 		{
 			performance_counters.sampled_frames++;
 
+			if (g_perf_tuner.is_measuring())
+			{
+				g_perf_tuner.on_flip(rsx::uclock());
+			}
+
 			if (m_pause_on_first_flip)
 			{
 				Emu.Pause();
@@ -386,10 +386,16 @@ namespace rsx
 	{
 		u32 draw_calls;
 		u32 submit_count;
+		u32 zcull_reports;
+		u32 zcull_forced_syncs;
+		u32 fifo_memo_hits;
+		u32 fifo_memo_methods;
 
 		s64 setup_time;
 		s64 vertex_upload_time;
 		s64 textures_upload_time;
+		u64 textures_staged_bytes;
+		u64 textures_zero_copy_bytes;
 		s64 draw_exec_time;
 		s64 flip_time;
 	};
@@ -476,6 +482,7 @@ namespace rsx
 
 	protected:
 		FIFO::flattening_helper m_flattener;
+		FIFO::memoization_helper m_memoizer;
 		u32 fifo_ret_addr = RSX_CALL_STACK_EMPTY;
 		u32 saved_fifo_ret = RSX_CALL_STACK_EMPTY;
 
@@ -698,6 +705,7 @@ namespace rsx
 		virtual void emit_geometry(u32) {}
 
 		void run_FIFO();
+		void memoize_region(u32 start);
 
 	public:
 		thread(const thread&) = delete;
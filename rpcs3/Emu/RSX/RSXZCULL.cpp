@@ -231,6 +231,7 @@ namespace rsx
 				}
 
 				m_next_tsc = 0;
+				ptimer->get_stats().zcull_forced_syncs++;
 				update(ptimer, m_pending_writes.front().sink);
 
 				retries++;
@@ -388,6 +389,8 @@ namespace rsx
 				return;
 			}
 
+			ptimer->get_stats().zcull_forced_syncs++;
+
 			// Quick reverse scan to push commands ahead of time
 			for (auto It = m_pending_writes.rbegin(); It != m_pending_writes.rend(); ++It)
 			{
@@ -440,27 +443,9 @@ namespace rsx
 				processed++;
 			}
 
-			if (!has_unclaimed)
-			{
-				ensure(processed == m_pending_writes.size());
-				m_pending_writes.clear();
-			}
-			else
-			{
-				auto remaining = m_pending_writes.size() - processed;
-				ensure(remaining > 0);
-
-				if (remaining == 1)
-				{
-					m_pending_writes[0] = std::move(m_pending_writes.back());
-					m_pending_writes.resize(1);
-				}
-				else
-				{
-					std::move(m_pending_writes.begin() + processed, m_pending_writes.end(), m_pending_writes.begin());
-					m_pending_writes.resize(remaining);
-				}
-			}
+			// Unclaimed writes stay queued at the back
+			ensure(has_unclaimed ? processed < m_pending_writes.size() : processed == m_pending_writes.size());
+			pop_retired(ptimer, processed);
 
 			//Delete all statistics caches but leave the current one
 			for (auto It = m_statistics_map.begin(); It != m_statistics_map.end(); )
@@ -470,9 +455,6 @@ namespace rsx
 				else
 					It = m_statistics_map.erase(It);
 			}
-
-			//Decrement jobs counter
-			ptimer->async_tasks_pending -= processed;
 		}
 
 		void ZCULL_control::update(::rsx::thread* ptimer, u32 sync_address, bool hint)
@@ -509,7 +491,15 @@ namespace rsx
 					}
 				}
 
-				if (m_tsc = rsx::uclock(); m_tsc < m_next_tsc)
+				// Once a counter has registered a hit the imprecise result is final, reports waiting on it can be published without reading back any query
+				const auto counter = m_statistics_map.find(front.counter_tag);
+				const bool result_known = !g_cfg.video.precise_zpass_count && counter != m_statistics_map.end() && counter->second.result;
+
+				if (result_known)
+				{
+					m_tsc = rsx::uclock();
+				}
+				else if (m_tsc = rsx::uclock(); m_tsc < m_next_tsc)
 				{
 					return;
 				}
@@ -597,26 +587,19 @@ namespace rsx
 
 			if (processed)
 			{
-				auto remaining = m_pending_writes.size() - processed;
-				if (remaining == 1)
-				{
-					m_pending_writes[0] = std::move(m_pending_writes.back());
-					m_pending_writes.resize(1);
-				}
-				else if (remaining)
-				{
-					std::move(m_pending_writes.begin() + processed, m_pending_writes.end(), m_pending_writes.begin());
-					m_pending_writes.resize(remaining);
-				}
-				else
-				{
-					m_pending_writes.clear();
-				}
-
-				ptimer->async_tasks_pending -= processed;
+				pop_retired(ptimer, processed);
 			}
 		}
 
+		void ZCULL_control::pop_retired(::rsx::thread* ptimer, u32 count)
+		{
+			// Retired entries are always at the front, erasing them does not move the rest of the queue
+			m_pending_writes.erase(m_pending_writes.begin(), m_pending_writes.begin() + count);
+
+			ptimer->async_tasks_pending -= count;
+			ptimer->get_stats().zcull_reports += count;
+		}
+
 		flags32_t ZCULL_control::read_barrier(::rsx::thread* ptimer, u32 memory_address, u32 memory_range, flags32_t flags)
 		{
 			if (m_pending_writes.empty())
@@ -690,6 +673,8 @@ namespace rsx
 					}
 				}
 
+				ptimer->get_stats().zcull_forced_syncs++;
+
 				// There can be multiple queries all writing to the same address, loop to flush all of them
 				while (query->pending)
 				{
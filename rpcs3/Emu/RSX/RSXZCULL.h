@@ -6,6 +6,7 @@
 
 #include "rsx_utils.h"
 
+#include <deque>
 #include <vector>
 #include <stack>
 #include <unordered_map>
@@ -125,7 +126,8 @@ namespace rsx
 			u64 m_sync_tag = 0;
 			u64 m_timer = 0;
 
-			std::vector<queued_report_write> m_pending_writes{};
+			// Ordered queue of report writes. Retired from the front in batches, the back stays addressable while new reports are chained
+			std::deque<queued_report_write> m_pending_writes{};
 			std::unordered_map<u32, query_stat_counter> m_statistics_map{};
 
 			// Enables/disables the ZCULL unit
@@ -147,6 +149,9 @@ namespace rsx
 			// Retire operation
 			void retire(class ::rsx::thread* ptimer, queued_report_write* writer, u32 result);
 
+			// Removes the first 'count' retired writes from the queue
+			void pop_retired(class ::rsx::thread* ptimer, u32 count);
+
 		public:
 
 			ZCULL_control();
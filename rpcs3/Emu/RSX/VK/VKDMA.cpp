@@ -174,6 +174,11 @@ namespace vk
 		// NOTE: Do not unmap. This can be extremely slow on some platforms.
 	}
 
+	bool dma_block::is_host_imported() const
+	{
+		return inheritance_info.parent && inheritance_info.parent->is_host_imported();
+	}
+
 	std::pair<u32, buffer*> dma_block::get(const utils::address_range& range)
 	{
 		if (inheritance_info.parent)
@@ -284,6 +289,11 @@ namespace vk
 		// NOP
 	}
 
+	bool dma_block_EXT::is_host_imported() const
+	{
+		return true;
+	}
+
 	bool test_host_pointer([[maybe_unused]] u32 base_address, [[maybe_unused]] usz length)
 	{
 #ifdef _WIN32
@@ -443,10 +453,12 @@ namespace vk
 	}
 
 	template<bool load>
-	void sync_dma_impl(u32 local_address, u32 length)
+	u32 sync_dma_impl(u32 local_address, u32 length)
 	{
 		reader_lock lock(g_dma_mutex);
 
+		u32 copied = 0;
+
 		const auto limit = local_address + length - 1;
 		while (length)
 		{
@@ -465,6 +477,11 @@ namespace vk
 					found->second->flush(range);
 				}
 
+				if (!found->second->is_host_imported())
+				{
+					copied += range.length();
+				}
+
 				if (sync_end < limit) [[unlikely]]
 				{
 					// Technically legal but assuming a map->flush usage, this shouldnot happen
@@ -482,14 +499,16 @@ namespace vk
 			else
 			{
 				rsx_log.error("Sync command on range not mapped!");
-				return;
+				break;
 			}
 		}
+
+		return copied;
 	}
 
-	void load_dma(u32 local_address, u32 length)
+	u32 load_dma(u32 local_address, u32 length)
 	{
-		sync_dma_impl<true>(local_address, length);
+		return sync_dma_impl<true>(local_address, length);
 	}
 
 	void flush_dma(u32 local_address, u32 length)
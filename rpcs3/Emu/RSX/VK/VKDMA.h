@@ -5,7 +5,7 @@
 namespace vk
 {
 	std::pair<u32, vk::buffer*> map_dma(u32 local_address, u32 length);
-	void load_dma(u32 local_address, u32 length);
+	u32 load_dma(u32 local_address, u32 length); // Returns the number of bytes copied (guest memory imported by the host is never copied)
 	void flush_dma(u32 local_address, u32 length);
 	void unmap_dma(u32 local_address, u32 length);
 
@@ -39,6 +39,7 @@ namespace vk
 		virtual void init(dma_block* parent, u32 addr, usz size);
 		virtual void flush(const utils::address_range& range);
 		virtual void load(const utils::address_range& range);
+		virtual bool is_host_imported() const;
 		std::pair<u32, buffer*> get(const utils::address_range& range);
 
 		u32 start() const;
@@ -61,5 +62,6 @@ namespace vk
 	public:
 		void flush(const utils::address_range& range) override;
 		void load(const utils::address_range& range) override;
+		bool is_host_imported() const override;
 	};
 }
@@ -783,6 +783,9 @@ void VKGSRender::flip(const rsx::display_flip_info_t& info)
 			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 4, 180, direct_fbo->width(), direct_fbo->height(), fmt::format("Temporary texture memory: %3dM", tmp_texture_memory_size));
 			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 4, 198, direct_fbo->width(), direct_fbo->height(), fmt::format("Flush requests: %13d  = %2d (%3d%%) hard faults, %2d unavoidable, %2d misprediction(s), %2d speculation(s)", num_flushes, num_misses, cache_miss_ratio, num_unavoidable, num_mispredict, num_speculate));
 			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 4, 216, direct_fbo->width(), direct_fbo->height(), fmt::format("Texture uploads: %14u (%u from CPU - %02u%%)", num_texture_upload, num_texture_upload_miss, texture_upload_miss_ratio));
+			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 4, 234, direct_fbo->width(), direct_fbo->height(), fmt::format("Texture data: %17uK (%uK zero-copy)", (info.stats.textures_staged_bytes + info.stats.textures_zero_copy_bytes) / 1024, info.stats.textures_zero_copy_bytes / 1024));
+			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 4, 252, direct_fbo->width(), direct_fbo->height(), fmt::format("ZCULL reports: %15u (%u forced syncs)", info.stats.zcull_reports, info.stats.zcull_forced_syncs));
+			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 4, 270, direct_fbo->width(), direct_fbo->height(), fmt::format("Memoized FIFO regions: %7u (%u methods skipped)", info.stats.fifo_memo_hits, info.stats.fifo_memo_methods));
 		}
 
 		direct_fbo->release();
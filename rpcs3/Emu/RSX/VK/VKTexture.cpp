@@ -940,6 +940,13 @@ namespace vk
 				caps.supports_zero_copy = caps.supports_byteswap;
 				caps.supports_vtc_decoding = false;
 				check_caps = false;
+
+				if (!is_swizzled && g_cfg.video.zero_copy_linear_textures)
+				{
+					// Linear data can be sourced from guest memory as-is regardless of size, byteswap is then done in a compute pass
+					caps.supports_zero_copy = true;
+					caps.supports_byteswap = true;
+				}
 			}
 
 			std::span<std::byte> mapped{ static_cast<std::byte*>(mapped_buffer), image_linear_size };
@@ -981,17 +988,26 @@ namespace vk
 				auto dma_mapping = vk::map_dma(static_cast<u32>(src_address), static_cast<u32>(data_length));
 
 				ensure(dma_mapping.second->size() >= (dma_mapping.first + data_length));
-				vk::load_dma(::narrow<u32>(src_address), data_length);
+				const u32 copied = vk::load_dma(::narrow<u32>(src_address), data_length);
 
 				upload_buffer = dma_mapping.second;
 				offset_in_upload_buffer = dma_mapping.first;
 				copy_info.bufferOffset = offset_in_upload_buffer;
+
+				// Without host memory import, the DMA block is a copy of guest memory
+				auto& stats = rsx::get_current_renderer()->get_stats();
+				(copied ? stats.textures_staged_bytes : stats.textures_zero_copy_bytes) += layout.data.size_bytes();
 			}
-			else if (!layout.layer && !layout.level)
+			else
 			{
-				// Do not allow mixed transfer modes.
-				// This can happen in special cases, e.g mipN having different processing than mip0 as is the case with the last VTC mip
-				caps.supports_zero_copy = false;
+				rsx::get_current_renderer()->get_stats().textures_staged_bytes += layout.data.size_bytes();
+
+				if (!layout.layer && !layout.level)
+				{
+					// Do not allow mixed transfer modes.
+					// This can happen in special cases, e.g mipN having different processing than mip0 as is the case with the last VTC mip
+					caps.supports_zero_copy = false;
+				}
 			}
 
 			if (opt.require_swap || opt.require_deswizzle || requires_depth_processing)
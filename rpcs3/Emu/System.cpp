@@ -7,6 +7,7 @@
 #include "Emu/system_utils.hpp"
 #include "Emu/perf_meter.hpp"
 #include "Emu/perf_monitor.hpp"
+#include "Emu/guest_profiler.hpp"
 #include "Emu/vfs_config.h"
 #include "Emu/IPC_config.h"
 
@@ -30,6 +31,7 @@
 #include "Loader/TAR.h"
 #include "Loader/ELF.h"
 #include "Loader/disc.h"
+#include "Loader/ISO.h"
 
 #include "Utilities/StrUtil.h"
 
@@ -522,6 +524,9 @@ void Emulator::Init(bool add_only)
 		rpcs3::cache::limit_cache_size();
 	}
 
+	// Limit compiled PPU object store size
+	rpcs3::cache::limit_object_store();
+
 	// Wipe clean VSH's temporary directory of choice
 	if (g_cfg.vfs.empty_hdd0_tmp && !fs::remove_all(dev_hdd0 + "tmp/", false, true))
 	{
@@ -711,6 +716,19 @@ game_boot_result Emulator::BootGame(const std::string& path, const std::string&
 		return game_boot_result::invalid_file_or_folder;
 	}
 
+	if (is_file_iso(path))
+	{
+		// Boot the disc image from its mounted root directory
+		const std::string iso_root = iso_mount(path);
+
+		if (iso_root.empty())
+		{
+			return game_boot_result::invalid_file_or_folder;
+		}
+
+		return BootGame(iso_root, title_id, false, add_only, config_mode, config_path);
+	}
+
 	m_path_old = m_path;
 
 	m_config_mode = config_mode;
@@ -929,7 +947,7 @@ game_boot_result Emulator::Load(const std::string& title_id, bool add_only, bool
 				// Load /dev_bdvd/ from game list if available
 				if (auto node = games[m_title_id])
 				{
-					disc = node.Scalar();
+					disc = resolve_iso_path(node.Scalar());
 				}
 				else
 				{
@@ -1159,8 +1177,7 @@ game_boot_result Emulator::Load(const std::string& title_id, bool add_only, bool
 			g_fxo->need<patch_engine>();
 
 			// Load patches from different locations
-			g_fxo->get<patch_engine>().append_global_patches();
-			g_fxo->get<patch_engine>().append_title_patches(m_title_id);
+			g_fxo->get<patch_engine>().append_boot_patches(m_title_id);
 		}
 
 		if (g_use_rtm)
@@ -1374,7 +1391,7 @@ game_boot_result Emulator::Load(const std::string& title_id, bool add_only, bool
 			// Load /dev_bdvd/ from game list if available
 			if (auto node = games[m_title_id])
 			{
-				bdvd_dir = node.Scalar();
+				bdvd_dir = resolve_iso_path(node.Scalar());
 			}
 			else
 			{
@@ -1418,8 +1435,8 @@ game_boot_result Emulator::Load(const std::string& title_id, bool add_only, bool
 					sys_log.error("Unexpected PARAM.SFO found in disc directory '%s' (found '%s')", m_title_id, bdvd_title_id);
 				}
 
-				// Store /dev_bdvd/ location
-				games[m_title_id] = bdvd_dir;
+				// Store /dev_bdvd/ location (the image file for mounted disc images)
+				games[m_title_id] = iso_host_path(bdvd_dir);
 				YAML::Emitter out;
 				out << games;
 
@@ -1505,6 +1522,9 @@ game_boot_result Emulator::Load(const std::string& title_id, bool add_only, bool
 		// Initialize performance monitor
 		g_fxo->init<named_thread<perf_monitor>>();
 
+		// Initialize guest profiler (does nothing unless enabled)
+		g_fxo->init<named_thread<guest_profiler>>();
+
 		// Set title to actual disc title if necessary
 		const std::string disc_sfo_dir = vfs::get("/dev_bdvd/PS3_GAME/PARAM.SFO");
 
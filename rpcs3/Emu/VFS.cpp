@@ -33,6 +33,15 @@ struct vfs_manager
 	vfs_directory root{};
 };
 
+static void clear_metadata_cache()
+{
+	// Cached lookups may point to the previous mount
+	if (auto cache = g_fxo->try_get<lv2_fs_metadata_cache>())
+	{
+		cache->clear();
+	}
+}
+
 bool vfs::mount(std::string_view vpath, std::string_view path)
 {
 	if (vpath.empty())
@@ -71,6 +80,7 @@ bool vfs::mount(std::string_view vpath, std::string_view path)
 			list.back()->path = Emu.GetCallbacks().resolve_path(path);
 			list.back()->path += '/';
 			vfs_log.notice("Mounted path \"%s\" to \"%s\"", vpath_backup, list.back()->path);
+			clear_metadata_cache();
 			return true;
 		}
 
@@ -176,6 +186,7 @@ bool vfs::unmount(std::string_view vpath)
 		}
 	};
 	unmount_children(table.root, 0);
+	clear_metadata_cache();
 
 	return true;
 }
@@ -931,6 +942,7 @@ bool vfs::host::rename(const std::string& from, const std::string& to, const lv2
 				file.file.sync(); // For cellGameContentPermit atomicity
 			}
 
+			std::lock_guard io_lock(file.io_mutex);
 			file.file.close(); // Actually close it!
 		}
 	});
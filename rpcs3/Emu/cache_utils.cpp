@@ -6,6 +6,8 @@
 #include "Emu/Cell/PPUAnalyser.h"
 #include "Emu/Cell/PPUThread.h"
 
+#include <unordered_map>
+
 LOG_CHANNEL(sys_log, "SYS");
 
 namespace rpcs3::cache
@@ -106,4 +108,188 @@ namespace rpcs3::cache
 
 		sys_log.success("Cleaned disk cache, removed %.2f MB", size / 1024.0 / 1024.0);
 	}
+
+	std::string get_object_store()
+	{
+		return fs::get_cache_dir() + "cache/objects/";
+	}
+
+	void write_object_manifest(const std::string& cache_path, const std::vector<std::string>& objects)
+	{
+		std::string manifest;
+
+		for (const auto& name : objects)
+		{
+			manifest += name;
+			manifest += '\n';
+		}
+
+		if (!fs::write_file(cache_path + "objects.lst", fs::rewrite, manifest))
+		{
+			sys_log.error("Failed to write object manifest in '%s' (%s)", cache_path, fs::g_tls_error);
+		}
+	}
+
+	void limit_object_store()
+	{
+		const std::string cache_dir = fs::get_cache_dir() + "cache/";
+		const std::string store = get_object_store();
+		const u64 max_size = static_cast<u64>(g_cfg.core.ppu_llvm_object_store_limit) * 1024 * 1024;
+
+		if (!max_size || !fs::is_dir(store))
+		{
+			return;
+		}
+
+		struct object_info
+		{
+			u64 size = 0;
+			u32 refs = 0;
+			s64 mtime = 0;
+		};
+
+		struct manifest_info
+		{
+			std::string path;
+			s64 mtime;
+			std::vector<std::string> objects;
+		};
+
+		std::unordered_map<std::string, object_info> objects;
+		u64 size = 0;
+
+		for (const auto& entry : fs::dir(store))
+		{
+			const usz pos = entry.name.find(".obj");
+
+			if (entry.is_directory || pos == umax)
+			{
+				continue;
+			}
+
+			// Compressed object and its compilation log
+			auto& obj = objects[entry.name.substr(0, pos + 4)];
+			obj.size += entry.size;
+			obj.mtime = std::max(obj.mtime, entry.mtime);
+			size += entry.size;
+		}
+
+		if (size <= max_size)
+		{
+			sys_log.trace("Object store size below limit: %llu/%llu", size, max_size);
+			return;
+		}
+
+		sys_log.success("Cleaning object store...");
+
+		// Manifests are found in the module directories (cache/ppu-*/ and cache/<title>/ppu-*/)
+		std::vector<manifest_info> manifests;
+
+		const auto scan = [&](const std::string& dir)
+		{
+			for (const auto& entry : fs::dir(dir))
+			{
+				if (!entry.is_directory || !entry.name.starts_with("ppu-"))
+				{
+					continue;
+				}
+
+				const std::string path = dir + entry.name + "/objects.lst";
+
+				if (fs::file file{path})
+				{
+					auto& manifest = manifests.emplace_back(manifest_info{path, file.stat().mtime, {}});
+					manifest.objects = fmt::split(file.to_string(), {"\n"});
+
+					for (const auto& name : manifest.objects)
+					{
+						if (auto found = objects.find(name); found != objects.end())
+						{
+							found->second.refs++;
+							found->second.mtime = std::max(found->second.mtime, manifest.mtime);
+						}
+					}
+				}
+			}
+		};
+
+		scan(cache_dir);
+
+		for (const auto& entry : fs::dir(cache_dir))
+		{
+			if (entry.is_directory && entry.name != "." && entry.name != ".." && entry.name != "objects" && !entry.name.starts_with("ppu-"))
+			{
+				scan(cache_dir + entry.name + '/');
+			}
+		}
+
+		// Clean down to 80% of the limit like the disk cache
+		const u64 target = static_cast<u64>(max_size * 0.8);
+		u64 removed = 0;
+
+		const auto remove_object = [&](const std::string& name, const object_info& obj)
+		{
+			for (const char* ext : {".gz", ".log"})
+			{
+				if (!fs::remove_file(store + name + ext) && fs::g_tls_error != fs::error::noent)
+				{
+					sys_log.error("Could not remove object '%s%s' (%s)", name, ext, fs::g_tls_error);
+				}
+			}
+
+			removed += obj.size;
+		};
+
+		// Remove the objects no longer referenced by any manifest first (oldest first)
+		std::vector<std::pair<std::string, object_info>> orphans;
+
+		for (const auto& [name, obj] : objects)
+		{
+			if (!obj.refs)
+			{
+				orphans.emplace_back(name, obj);
+			}
+		}
+
+		std::sort(orphans.begin(), orphans.end(), FN(x.second.mtime < y.second.mtime));
+
+		for (const auto& [name, obj] : orphans)
+		{
+			if (size - removed <= target)
+			{
+				break;
+			}
+
+			remove_object(name, obj);
+			objects.erase(name);
+		}
+
+		// Then drop the least recently used manifests, releasing their objects
+		std::sort(manifests.begin(), manifests.end(), FN(x.mtime < y.mtime));
+
+		for (const auto& manifest : manifests)
+		{
+			if (size - removed <= target)
+			{
+				break;
+			}
+
+			if (!fs::remove_file(manifest.path))
+			{
+				sys_log.error("Could not remove object manifest '%s' (%s)", manifest.path, fs::g_tls_error);
+				break;
+			}
+
+			for (const auto& name : manifest.objects)
+			{
+				if (auto found = objects.find(name); found != objects.end() && !--found->second.refs)
+				{
+					remove_object(name, found->second);
+					objects.erase(found);
+				}
+			}
+		}
+
+		sys_log.success("Cleaned object store, removed %.2f MB", removed / 1024.0 / 1024.0);
+	}
 }
@@ -4,4 +4,13 @@ namespace rpcs3::cache
 {
 	std::string get_ppu_cache();
 	void limit_cache_size();
+
+	// Directory of the compiled PPU objects shared by all titles (objects are named by their content hash)
+	std::string get_object_store();
+
+	// Record the objects used by a module cache directory, also marks them as recently used
+	void write_object_manifest(const std::string& cache_path, const std::vector<std::string>& objects);
+
+	// Remove the least recently used manifests and the objects that are no longer referenced until the store fits in the size limit
+	void limit_object_store();
 }
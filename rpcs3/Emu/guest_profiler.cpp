@@ -0,0 +1,339 @@
+#include "stdafx.h"
+#include "guest_profiler.hpp"
+
+#include "Emu/IdManager.h"
+#include "Emu/System.h"
+#include "Emu/system_config.h"
+#include "Emu/Cell/PPUFunction.h"
+#include "Emu/Cell/PPUModule.h"
+#include "Emu/Cell/PPUThread.h"
+#include "Emu/Cell/SPUThread.h"
+#include "Emu/Cell/lv2/sys_prx.h"
+#include "Utilities/date_time.h"
+#include "Utilities/File.h"
+#include "Utilities/Thread.h"
+
+#include <algorithm>
+
+LOG_CHANNEL(prof_log, "Profiler");
+
+static constexpr u32 no_frame = umax;
+
+u32 guest_profiler::intern(std::string name)
+{
+	if (const auto found = m_name_ids.find(name); found != m_name_ids.end())
+	{
+		return found->second;
+	}
+
+	const u32 id = ::size32(m_names);
+	m_name_ids.emplace(name, id);
+	m_names.emplace_back(std::move(name));
+	return id;
+}
+
+void guest_profiler::update_ppu_symbols()
+{
+	// Module identity: object id (0 for the main executable) and load address
+	const auto module_key = [](u32 id, const ppu_module& _module)
+	{
+		return std::make_pair(id, _module.segs.empty() ? 0 : _module.segs[0].addr);
+	};
+
+	const auto _main = g_fxo->try_get<ppu_module>();
+
+	std::vector<std::pair<u32, u32>> keys;
+
+	if (_main)
+	{
+		keys.emplace_back(module_key(0, *_main));
+	}
+
+	idm::select<lv2_obj, lv2_prx>([&](u32 id, lv2_prx& prx)
+	{
+		keys.emplace_back(module_key(id, prx));
+	});
+
+	// Rebuild only when modules were loaded or unloaded
+	if (keys == m_module_keys)
+	{
+		return;
+	}
+
+	m_ppu_symbols.clear();
+	m_module_keys.clear();
+
+	const auto add_module = [&](u32 id, const ppu_module& _module)
+	{
+		m_module_keys.emplace_back(module_key(id, _module));
+
+		const std::string module_name = _module.name.empty() ? "main" : _module.name;
+
+		for (const ppu_function& func : _module.funcs)
+		{
+			if (!func.size)
+			{
+				continue;
+			}
+
+			const std::string func_name = func.name.empty() ? fmt::format("sub_%x", func.addr) : func.name;
+			m_ppu_symbols.push_back({func.addr, func.addr + func.size, intern(fmt::format("%s!%s", module_name, func_name))});
+		}
+	};
+
+	if (_main)
+	{
+		add_module(0, *_main);
+	}
+
+	// PRX objects may be unloaded at any time, they are only accessed under the lock
+	idm::select<lv2_obj, lv2_prx>([&](u32 id, lv2_prx& prx)
+	{
+		add_module(id, prx);
+	});
+
+	std::sort(m_ppu_symbols.begin(), m_ppu_symbols.end(), [](const ppu_symbol& a, const ppu_symbol& b)
+	{
+		return a.start < b.start;
+	});
+
+	// HLE function stubs live in a separate allocation, one 8-byte entry per registered function
+	if (const auto hle_funcs = g_fxo->try_get<ppu_function_manager>(); hle_funcs && m_hle_symbols.empty())
+	{
+		m_hle_addr = hle_funcs->addr;
+		m_hle_symbols.resize(ppu_function_manager::get().size(), no_frame);
+
+		for (const auto& [module_name, _module] : ppu_module_manager::get())
+		{
+			for (const auto& [fnid, func] : _module->functions)
+			{
+				if (func.index < m_hle_symbols.size())
+				{
+					m_hle_symbols[func.index] = intern(fmt::format("HLE %s!%s", module_name, func.name));
+				}
+			}
+		}
+	}
+
+	prof_log.notice("Loaded %d PPU symbols from %d modules", m_ppu_symbols.size(), m_module_keys.size());
+}
+
+u32 guest_profiler::get_ppu_frame(u32 addr)
+{
+	if (m_hle_addr && addr >= m_hle_addr && (addr - m_hle_addr) / 8 < m_hle_symbols.size())
+	{
+		if (const u32 frame = m_hle_symbols[(addr - m_hle_addr) / 8]; frame != no_frame)
+		{
+			return frame;
+		}
+	}
+
+	const auto found = std::upper_bound(m_ppu_symbols.begin(), m_ppu_symbols.end(), addr, [](u32 addr, const ppu_symbol& sym)
+	{
+		return addr < sym.start;
+	});
+
+	if (found != m_ppu_symbols.begin() && addr < (found - 1)->end)
+	{
+		return (found - 1)->name;
+	}
+
+	// Unknown code, group by 4 KiB page to keep the output readable
+	return intern(fmt::format("unk_%x", addr & -4096));
+}
+
+void guest_profiler::sample()
+{
+	const auto is_running = [](bs_t<cpu_flag> state)
+	{
+		// Skip threads which are blocked in a syscall or waiting for an event
+		return !::is_paused(state) && !::is_stopped(state) && cpu_flag::wait - state;
+	};
+
+	const auto get_thread_frame = [this](const cpu_thread& cpu, u32 id)
+	{
+		if (const auto found = m_thread_ids.find(id); found != m_thread_ids.end())
+		{
+			return found->second;
+		}
+
+		const u32 frame = intern(cpu.get_name());
+		m_thread_ids.emplace(id, frame);
+		return frame;
+	};
+
+	idm::select<named_thread<ppu_thread>>([&](u32 id, ppu_thread& ppu)
+	{
+		if (!is_running(+ppu.state))
+		{
+			return;
+		}
+
+		const u32 cia = ppu.cia;
+		const u32 lr = static_cast<u32>(ppu.lr);
+		u32 callee = no_frame;
+
+		// Functions implemented in HLE report their name while they are executed
+		if (const char* func = ppu.current_function)
+		{
+			auto [found, inserted] = m_current_function_ids.emplace(func, 0);
+
+			if (inserted)
+			{
+				found->second = intern(fmt::format("HLE %s", func));
+			}
+
+			callee = found->second;
+		}
+		else
+		{
+			callee = get_ppu_frame(cia);
+		}
+
+		u32 caller = get_ppu_frame(lr & ~3);
+
+		if (caller == callee)
+		{
+			// LR is stale or points into the same function
+			caller = no_frame;
+		}
+
+		m_stacks[{get_thread_frame(ppu, id), caller, callee}]++;
+		m_sample_count++;
+	});
+
+	idm::select<named_thread<spu_thread>>([&](u32 id, spu_thread& spu)
+	{
+		if (!is_running(+spu.state))
+		{
+			return;
+		}
+
+		// See spu_recompiler_base: the upper bits identify the program, the lower 16 bits the block entry
+		const u64 hash = atomic_storage<u64>::load(spu.block_hash);
+		const u32 pc = spu.pc;
+
+		u32 program = no_frame;
+
+		if (hash)
+		{
+			auto [found, inserted] = m_spu_program_ids.emplace(hash & -65536, 0);
+
+			if (inserted)
+			{
+				found->second = intern(fmt::format("spu-%012x", (hash & -65536) >> 16));
+			}
+
+			program = found->second;
+		}
+
+		const u64 block_key = hash ? ((hash & 0xffff) << 2) | (u64{1} << 63) : pc;
+		auto [found, inserted] = m_spu_address_ids.emplace(block_key, 0);
+
+		if (inserted)
+		{
+			found->second = intern(fmt::format("%s_0x%05x", hash ? "entry" : "pc", hash ? (hash & 0xffff) << 2 : pc));
+		}
+
+		m_stacks[{get_thread_frame(spu, id), program, found->second}]++;
+		m_sample_count++;
+	});
+}
+
+void guest_profiler::dump() const
+{
+	if (m_stacks.empty())
+	{
+		return;
+	}
+
+	const std::string dir = fs::get_cache_dir() + "profiler/";
+	const std::string path = dir + fmt::format("%s_%s.folded", Emu.GetTitleID().empty() ? "unknown" : Emu.GetTitleID(), date_time::current_time_narrow<'_'>());
+
+	if (!fs::create_path(dir))
+	{
+		prof_log.error("Failed to create directory %s (%s)", dir, fs::g_tls_error);
+		return;
+	}
+
+	std::string out;
+	std::unordered_map<u32, u64> self_samples;
+
+	for (const auto& [stack, count] : m_stacks)
+	{
+		out += m_names[stack[0]];
+
+		for (usz i = 1; i < stack.size(); i++)
+		{
+			if (stack[i] != no_frame)
+			{
+				out += ';';
+				out += m_names[stack[i]];
+			}
+		}
+
+		fmt::append(out, " %u\n", count);
+		self_samples[stack[2]] += count;
+	}
+
+	if (!fs::write_file(path, fs::rewrite, out))
+	{
+		prof_log.error("Failed to write %s (%s)", path, fs::g_tls_error);
+		return;
+	}
+
+	// Log the hottest functions for a quick overview
+	std::vector<std::pair<u64, u32>> top;
+
+	for (const auto& [frame, count] : self_samples)
+	{
+		top.emplace_back(count, frame);
+	}
+
+	std::sort(top.begin(), top.end(), std::greater<>());
+
+	std::string summary;
+
+	for (usz i = 0; i < std::min<usz>(top.size(), 10); i++)
+	{
+		fmt::append(summary, "\n%5.1f%% %s", top[i].first * 100. / m_sample_count, m_names[top[i].second]);
+	}
+
+	prof_log.success("Wrote %u samples to %s. Top functions:%s", m_sample_count, path, summary);
+}
+
+void guest_profiler::operator()()
+{
+	if (!g_cfg.core.guest_profiler)
+	{
+		return;
+	}
+
+	const u64 interval = g_cfg.core.guest_profiler_interval;
+	u64 since_update = umax;
+
+	prof_log.notice("Guest profiler started (interval=%uus)", interval);
+
+	while (thread_ctrl::state() != thread_state::aborting)
+	{
+		thread_ctrl::wait_for(interval);
+
+		if (!Emu.IsRunning())
+		{
+			continue;
+		}
+
+		// Check for newly loaded modules about once per second
+		if (since_update >= 1'000'000)
+		{
+			update_ppu_symbols();
+			since_update = 0;
+		}
+
+		since_update += interval;
+
+		sample();
+	}
+
+	dump();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "util/types.hpp"
+
+#include <array>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Sampling profiler for guest code. Periodically samples all PPU and SPU threads,
+// symbolizes the samples against the loaded PPU modules and the HLE function tables,
+// and writes them as folded stacks (flamegraph.pl / speedscope input) on shutdown.
+class guest_profiler
+{
+	struct ppu_symbol
+	{
+		u32 start;
+		u32 end;
+		u32 name;
+	};
+
+	// Interned frame names
+	std::vector<std::string> m_names;
+	std::unordered_map<std::string, u32> m_name_ids;
+
+	// PPU functions of all loaded modules, sorted by address
+	std::vector<ppu_symbol> m_ppu_symbols;
+	std::vector<std::pair<u32, u32>> m_module_keys; // Object id and load address of each module
+
+	// HLE function index -> frame name
+	std::vector<u32> m_hle_symbols;
+	u32 m_hle_addr = 0;
+
+	// Frame names cached by key (HLE name pointers, thread ids, SPU block hashes)
+	std::unordered_map<const void*, u32> m_current_function_ids;
+	std::unordered_map<u32, u32> m_thread_ids;
+	std::unordered_map<u64, u32> m_spu_program_ids;
+	std::unordered_map<u64, u32> m_spu_address_ids;
+
+	// Folded stack (thread, caller/program, callee/block) -> sample count
+	std::map<std::array<u32, 3>, u64> m_stacks;
+	u64 m_sample_count = 0;
+
+	u32 intern(std::string name);
+	void update_ppu_symbols();
+	u32 get_ppu_frame(u32 addr);
+	void sample();
+	void dump() const;
+
+public:
+	void operator()();
+
+	static constexpr auto thread_name = "Guest Profiler"sv;
+};
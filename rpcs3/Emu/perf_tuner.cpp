@@ -0,0 +1,402 @@
+#include "stdafx.h"
+#include "perf_tuner.hpp"
+
+#include "Emu/System.h"
+#include "Emu/Cell/timers.hpp"
+#include "Emu/system_config.h"
+#include "Emu/system_utils.hpp"
+#include "Utilities/File.h"
+#include "Utilities/StrUtil.h"
+#include "util/sysinfo.hpp"
+#include "util/yaml.hpp"
+
+#include <algorithm>
+
+LOG_CHANNEL(tune_log, "Tuner");
+
+perf_tuner g_perf_tuner;
+
+static cfg::_base* find_entry(cfg::node& root, const std::vector<std::string>& path)
+{
+	cfg::_base* entry = &root;
+
+	for (const std::string& name : path)
+	{
+		if (entry->get_type() != cfg::type::node)
+		{
+			return nullptr;
+		}
+
+		const auto& nodes = static_cast<cfg::node*>(entry)->get_nodes();
+		const auto found = std::find_if(nodes.begin(), nodes.end(), [&](cfg::_base* node) { return node->get_name() == name; });
+
+		if (found == nodes.end())
+		{
+			return nullptr;
+		}
+
+		entry = *found;
+	}
+
+	return entry;
+}
+
+void perf_tuner::start(u32 frames, boot_func boot)
+{
+	const auto bool_setting = [](std::string section, std::string name)
+	{
+		setting result{name, {}};
+		result.options.push_back({"false", {{{section, name}, "false"}}});
+		result.options.push_back({"true", {{{section, name}, "true"}}});
+		return result;
+	};
+
+	const auto enum_setting = [](std::string section, std::string name, std::initializer_list<std::string> values)
+	{
+		setting result{name, {}};
+
+		for (const std::string& value : values)
+		{
+			result.options.push_back({value, {{{section, name}, value}}});
+		}
+
+		return result;
+	};
+
+	m_settings.clear();
+	m_settings.push_back(enum_setting("Core", "SPU Block Size", {"Safe", "Mega", "Giga"}));
+
+	setting spu_threads{"Preferred SPU Threads", {}};
+
+	for (u32 i = 0; i <= std::min<u32>(utils::get_thread_count() / 2, 6); i++)
+	{
+		spu_threads.options.push_back({std::to_string(i), {{{"Core", "Preferred SPU Threads"}, std::to_string(i)}}});
+	}
+
+	m_settings.push_back(std::move(spu_threads));
+	m_settings.push_back(bool_setting("Core", "SPU loop detection"));
+	m_settings.push_back(bool_setting("Core", "SPU GETLLAR polling detection"));
+	m_settings.push_back(enum_setting("Core", "Thread Scheduler Mode", {"Operating System", "RPCS3 Scheduler", "RPCS3 Alternative Scheduler"}));
+
+	// Renderer settings (RSX FIFO accuracy, ZCULL precision) are not searched, the Null renderer can't measure them
+
+	m_best.assign(m_settings.size(), umax);
+	m_best_result = {};
+	m_setting = 0;
+	m_option = umax;
+	m_frames = std::max<u32>(frames, 100);
+	m_boot = std::move(boot);
+
+	tune_log.notice("Performance tuning started: %u settings, %u frames per candidate", m_settings.size(), m_frames);
+
+	// Fail the candidates which stop flipping (static screen, hang) before the measurement is complete
+	m_watchdog = std::make_unique<named_thread<std::function<void()>>>("Tuner Watchdog", [this]()
+	{
+		const u64 timeout = boot_timeout + (warmup_frames + m_frames) * 1'000'000 / min_frame_rate;
+
+		while (thread_ctrl::state() != thread_state::aborting)
+		{
+			thread_ctrl::wait_for(1'000'000);
+
+			if (const u32 candidate = m_candidate; m_measuring && get_system_time() - m_boot_time > timeout)
+			{
+				Emu.CallFromMainThread([this, candidate]()
+				{
+					fail(candidate, "timed out");
+				}, nullptr, false);
+			}
+		}
+	});
+
+	// Baseline with the regular config of the title
+	if (!boot(""))
+	{
+		tune_log.fatal("Performance tuning failed: the title could not be booted");
+		m_boot = {};
+		m_watchdog.reset();
+		Emu.Quit(true);
+	}
+}
+
+bool perf_tuner::boot(const std::string& config_path)
+{
+	m_samples.clear();
+	m_flip_count = 0;
+	m_boot_time = get_system_time();
+	m_candidate++;
+	m_measuring = true;
+
+	if (m_boot(config_path))
+	{
+		return true;
+	}
+
+	m_measuring = false;
+	return false;
+}
+
+void perf_tuner::on_stop()
+{
+	if (!m_measuring)
+	{
+		return;
+	}
+
+	// Title exit, fatal error or external stop (the emulator is not stopped completely yet)
+	Emu.CallFromMainThread([this, candidate = m_candidate.load()]()
+	{
+		fail(candidate, "stopped before the measurement was complete");
+	}, nullptr, false);
+}
+
+void perf_tuner::fail(u32 candidate, const char* reason)
+{
+	// Ignore stale notifications and candidates which completed in the meantime
+	if (!m_boot || candidate != m_candidate || !m_measuring.exchange(false))
+	{
+		return;
+	}
+
+	if (m_option == umax)
+	{
+		tune_log.fatal("Performance tuning failed: the baseline run %s", reason);
+		m_boot = {};
+		m_watchdog.reset();
+		Emu.Kill(false);
+		Emu.Quit(true);
+		return;
+	}
+
+	tune_log.error("%s=%s: %s", m_settings[m_setting].name, m_settings[m_setting].options[m_option].label, reason);
+
+	Emu.Kill(false);
+	boot_next();
+}
+
+void perf_tuner::on_flip(u64 timestamp)
+{
+	if (!m_measuring)
+	{
+		return;
+	}
+
+	if (++m_flip_count <= warmup_frames)
+	{
+		m_last_flip = timestamp;
+		return;
+	}
+
+	m_samples.push_back(timestamp - m_last_flip);
+	m_last_flip = timestamp;
+
+	if (m_samples.size() < m_frames)
+	{
+		return;
+	}
+
+	if (!m_measuring.exchange(false))
+	{
+		// Failed by the watchdog in the meantime
+		return;
+	}
+
+	std::sort(m_samples.begin(), m_samples.end());
+
+	const auto percentile = [this](usz p)
+	{
+		return m_samples[std::min(m_samples.size() - 1, m_samples.size() * p / 100)];
+	};
+
+	const result res{percentile(50), percentile(90), percentile(99)};
+
+	Emu.CallFromMainThread([this, res]()
+	{
+		complete(res);
+	}, nullptr, false);
+}
+
+void perf_tuner::complete(const result& res)
+{
+	if (!m_boot)
+	{
+		return;
+	}
+
+	if (m_option == umax)
+	{
+		m_title_id = Emu.GetTitleID();
+		m_base_config = g_cfg.to_string();
+		m_best_result = res;
+
+		tune_log.success("Baseline of %s: p50=%.2fms p90=%.2fms p99=%.2fms", m_title_id, res.p50 / 1000., res.p90 / 1000., res.p99 / 1000.);
+	}
+	else
+	{
+		const setting& s = m_settings[m_setting];
+		const bool better = res.p99 < m_best_result.p99 * noise_margin;
+
+		tune_log.notice("%s=%s: p50=%.2fms p90=%.2fms p99=%.2fms%s", s.name, s.options[m_option].label, res.p50 / 1000., res.p90 / 1000., res.p99 / 1000., better ? " (best)" : "");
+
+		if (better)
+		{
+			m_best[m_setting] = ::narrow<u32>(m_option);
+			m_best_result = res;
+		}
+	}
+
+	Emu.Kill(false);
+	boot_next();
+}
+
+std::string perf_tuner::make_config(const std::vector<u32>& selection) const
+{
+	cfg_root root;
+	root.from_string(m_base_config);
+
+	for (usz i = 0; i < m_settings.size(); i++)
+	{
+		if (selection[i] == umax)
+		{
+			continue;
+		}
+
+		for (const auto& [path, value] : m_settings[i].options[selection[i]].values)
+		{
+			if (cfg::_base* entry = find_entry(root, path); !entry || !entry->from_string(value))
+			{
+				tune_log.error("Failed to set %s to %s", fmt::merge(path, ": "), value);
+			}
+		}
+	}
+
+	// Each candidate must run unattended and boot from the same files
+	root.savestate.start_paused.set(false);
+	root.savestate.suspend_emu.set(false);
+	root.misc.autoexit.set(false);
+
+	return root.to_string();
+}
+
+void perf_tuner::boot_next()
+{
+	cfg_root base;
+	base.from_string(m_base_config);
+
+	const std::string config_path = fs::get_cache_dir() + "tuning/config_" + m_title_id + ".yml";
+
+	while (true)
+	{
+		if (m_option == umax)
+		{
+			m_setting = 0;
+			m_option = 0;
+		}
+		else if (++m_option >= m_settings[m_setting].options.size())
+		{
+			m_setting++;
+			m_option = 0;
+		}
+
+		if (m_setting >= m_settings.size())
+		{
+			finish();
+			return;
+		}
+
+		const option& opt = m_settings[m_setting].options[m_option];
+
+		// Skip the value of the base config, it was measured as the baseline
+		if (std::all_of(opt.values.begin(), opt.values.end(), [&](const auto& v) { const auto entry = find_entry(base, v.first); return !entry || entry->to_string() == v.second; }))
+		{
+			continue;
+		}
+
+		std::vector<u32> selection = m_best;
+		selection[m_setting] = ::narrow<u32>(m_option);
+
+		if (!fs::create_path(fs::get_parent_dir(config_path)) || !fs::write_file(config_path, fs::rewrite, make_config(selection)))
+		{
+			tune_log.error("Failed to write %s (%s)", config_path, fs::g_tls_error);
+			continue;
+		}
+
+		if (boot(config_path))
+		{
+			return;
+		}
+
+		tune_log.error("%s=%s: boot failed", m_settings[m_setting].name, opt.label);
+	}
+}
+
+void perf_tuner::finish()
+{
+	m_boot = {};
+	m_watchdog.reset();
+
+	fs::remove_file(fs::get_cache_dir() + "tuning/config_" + m_title_id + ".yml");
+
+	if (std::all_of(m_best.begin(), m_best.end(), [](u32 v) { return v == umax; }))
+	{
+		tune_log.success("Performance tuning of %s finished: the current config is already the fastest", m_title_id);
+		Emu.Quit(true);
+		return;
+	}
+
+	for (usz i = 0; i < m_settings.size(); i++)
+	{
+		if (m_best[i] != umax)
+		{
+			tune_log.success("%s: %s", m_settings[i].name, m_settings[i].options[m_best[i]].label);
+		}
+	}
+
+	const std::string path = rpcs3::utils::get_custom_config_path(m_title_id);
+
+	if (fs::is_file(path) && !fs::copy_file(path, path + ".bak", true))
+	{
+		tune_log.error("Failed to back up %s (%s)", path, fs::g_tls_error);
+	}
+
+	// Only add the tuned entries to the custom config, the effective config of the runs uses the Null renderer
+	YAML::Node custom;
+
+	if (fs::file cfg_file{path})
+	{
+		if (auto [node, error] = yaml_load(cfg_file.to_string()); error.empty() && node.IsMap())
+		{
+			custom = node;
+		}
+		else
+		{
+			tune_log.error("Failed to parse %s, it is replaced: %s", path, error);
+		}
+	}
+
+	for (usz i = 0; i < m_settings.size(); i++)
+	{
+		if (m_best[i] == umax)
+		{
+			continue;
+		}
+
+		for (const auto& [entry_path, value] : m_settings[i].options[m_best[i]].values)
+		{
+			custom[entry_path[0]][entry_path[1]] = value;
+		}
+	}
+
+	YAML::Emitter out;
+	out << custom;
+
+	if (fs::create_path(fs::get_parent_dir(path)) && fs::write_file(path, fs::rewrite, out.c_str(), out.size()))
+	{
+		tune_log.success("Performance tuning of %s finished: p50=%.2fms p90=%.2fms p99=%.2fms, saved to %s", m_title_id, m_best_result.p50 / 1000., m_best_result.p90 / 1000., m_best_result.p99 / 1000., path);
+	}
+	else
+	{
+		tune_log.fatal("Failed to write %s (%s)", path, fs::g_tls_error);
+	}
+
+	Emu.Quit(true);
+}
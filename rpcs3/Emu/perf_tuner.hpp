@@ -0,0 +1,104 @@
+#pragma once
+
+#include "util/types.hpp"
+#include "util/atomic.hpp"
+#include "Utilities/Thread.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Automatic per-title performance tuning. Boots the title once per configuration candidate,
+// measures the frame times of a fixed number of guest flips and searches the settings one at a time
+// (keeping the best value of each before moving to the next), then writes the tuned entries into the custom config.
+// Runs in headless mode, so the frame times are measured with the Null renderer: only CPU-side settings are searched.
+class perf_tuner
+{
+public:
+	// Boots the title with the given config file (empty: regular custom config), returns false on failure
+	using boot_func = std::function<bool(const std::string& config_path)>;
+
+	// Frames ignored after boot (loading, shader compilation)
+	static constexpr u32 warmup_frames = 300;
+
+	// A candidate must beat the best p99 frame time by this factor to be accepted (measurement noise)
+	static constexpr f64 noise_margin = 0.97;
+
+	// A candidate fails if it doesn't reach the measured frames in time (boot allowance + frames at 10 fps)
+	static constexpr u64 boot_timeout = 180'000'000;
+	static constexpr u64 min_frame_rate = 10;
+
+private:
+	struct option
+	{
+		std::string label;
+		std::vector<std::pair<std::vector<std::string>, std::string>> values; // Config path -> value
+	};
+
+	struct setting
+	{
+		std::string name;
+		std::vector<option> options;
+	};
+
+	struct result
+	{
+		u64 p50 = 0;
+		u64 p90 = 0;
+		u64 p99 = 0;
+	};
+
+	std::vector<setting> m_settings;
+	std::vector<u32> m_best; // Option index per setting (umax: unchanged from the base config)
+	result m_best_result{};
+
+	usz m_setting = 0; // Setting being searched
+	usz m_option = umax; // Option being measured (umax: baseline)
+
+	u32 m_frames = 0;
+	boot_func m_boot;
+
+	std::string m_title_id;
+	std::string m_base_config; // Effective config of the baseline boot
+
+	// Flip samples (only accessed by the RSX thread while measuring)
+	std::vector<u64> m_samples;
+	u64 m_last_flip = 0;
+	u32 m_flip_count = 0;
+
+	atomic_t<bool> m_measuring = false;
+
+	// Candidate number and its boot time, checked by the watchdog thread
+	atomic_t<u32> m_candidate = 0;
+	atomic_t<u64> m_boot_time = 0;
+	std::unique_ptr<named_thread<std::function<void()>>> m_watchdog;
+
+	std::string make_config(const std::vector<u32>& selection) const;
+	bool boot(const std::string& config_path);
+	void boot_next();
+	void finish();
+	void complete(const result& res);
+	void fail(u32 candidate, const char* reason);
+
+public:
+	perf_tuner() = default;
+	perf_tuner(const perf_tuner&) = delete;
+	perf_tuner& operator=(const perf_tuner&) = delete;
+
+	// Start tuning with the given number of measured frames per candidate
+	void start(u32 frames, boot_func boot);
+
+	// Called by RSX on each guest flip
+	void on_flip(u64 timestamp);
+
+	// Called when the emulation stops, a candidate which is still measured has failed
+	void on_stop();
+
+	bool is_measuring() const
+	{
+		return m_measuring.observe();
+	}
+};
+
+extern perf_tuner g_perf_tuner;
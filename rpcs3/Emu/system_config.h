@@ -28,6 +28,10 @@ struct cfg_root : cfg::node
 		cfg::_int<0, 1024> llvm_threads{ this, "Max LLVM Compile Threads", 0 };
 		cfg::_bool ppu_llvm_greedy_mode{ this, "PPU LLVM Greedy Mode", false, false };
 		cfg::_bool ppu_llvm_precompilation{ this, "PPU LLVM Precompilation", true };
+		cfg::_bool ppu_llvm_tiered{ this, "PPU LLVM Tiered Compilation", false }; // Start before all objects are compiled: missing functions run in the per-instruction interpreter fallback (no fast baseline JIT) until their LLVM part is compiled in background
+		cfg::_bool ppu_llvm_lazy{ this, "PPU LLVM Lazy Compilation", false }; // Like tiered compilation, but only compile the functions which are executed
+		cfg::_bool ppu_llvm_object_store{ this, "PPU LLVM Shared Object Store", true }; // Keep compiled objects in one content-addressed directory shared by all titles
+		cfg::uint<0, 1'000'000> ppu_llvm_object_store_limit{ this, "PPU LLVM Object Store Size Limit (MB)", 0 }; // 0: unlimited
 		cfg::_enum<thread_scheduler_mode> thread_scheduler{this, "Thread Scheduler Mode", thread_scheduler_mode::os};
 		cfg::_bool set_daz_and_ftz{ this, "Set DAZ and FTZ", false };
 		cfg::_enum<spu_decoder_type> spu_decoder{ this, "SPU Decoder", spu_decoder_type::llvm };
@@ -38,11 +42,14 @@ struct cfg_root : cfg::node
 		cfg::_int<0, 16> spu_delay_penalty{ this, "SPU delay penalty", 3 }; // Number of milliseconds to block a thread if a virtual 'core' isn't free
 		cfg::_bool spu_loop_detection{ this, "SPU loop detection", false, true }; // Try to detect wait loops and trigger thread yield
 		cfg::_int<0, 6> max_spurs_threads{ this, "Max SPURS Threads", 6 }; // HACK. If less then 6, max number of running SPURS threads in each thread group.
+		cfg::_int<0, 16> vdec_threads{ this, "Video Decoder Threads", 1 }; // FFmpeg frame/slice threads per cellVdec decoder. 0: Automatic, 1: Single-threaded
+		cfg::_bool vdec_async_conversion{ this, "Video Decoder Asynchronous Conversion", false }; // Convert decoded pictures on the decoder thread using the last format requested by the game
 		cfg::_enum<spu_block_size_type> spu_block_size{ this, "SPU Block Size", spu_block_size_type::safe };
 		cfg::_bool spu_accurate_getllar{ this, "Accurate GETLLAR", false, true };
 		cfg::_bool spu_accurate_dma{ this, "Accurate SPU DMA", false };
 		cfg::_bool accurate_cache_line_stores{ this, "Accurate Cache Line Stores", false };
 		cfg::_bool rsx_accurate_res_access{this, "Accurate RSX reservation access", false, true};
+		cfg::_bool huge_pages{ this, "Use Huge Pages", false }; // Ask the host to back 2 MiB aligned guest memory with transparent huge pages (NUMA placement is left to the host first-touch policy)
 
 		struct fifo_setting : public cfg::_enum<rsx_fifo_mode>
 		{
@@ -56,9 +63,12 @@ struct cfg_root : cfg::node
 		};
 
 		fifo_setting rsx_fifo_accuracy{this, "RSX FIFO Accuracy", rsx_fifo_mode::fast };
+		cfg::_bool rsx_fifo_decoder{ this, "RSX FIFO Asynchronous Decoding", false }; // Decode commands ahead of GET on another thread (only with accurate FIFO modes)
 		cfg::_bool spu_verification{ this, "SPU Verification", true }; // Should be enabled
 		cfg::_bool spu_cache{ this, "SPU Cache", true };
 		cfg::_bool spu_prof{ this, "SPU Profiler", false };
+		cfg::_bool guest_profiler{ this, "Guest Profiler", false }; // Sample PPU and SPU threads and write folded stacks to cache/profiler/
+		cfg::uint<100, 1'000'000> guest_profiler_interval{ this, "Guest Profiler Interval (us)", 1000 };
 		cfg::uint<0, 16> mfc_transfers_shuffling{ this, "MFC Commands Shuffling Limit", 0 };
 		cfg::uint<0, 10000> mfc_transfers_timeout{ this, "MFC Commands Timeout", 0, true };
 		cfg::_bool mfc_shuffling_in_steps{ this, "MFC Commands Shuffling In Steps", false, true };
@@ -110,6 +120,7 @@ struct cfg_root : cfg::node
 		cfg::_bool limit_cache_size{ this, "Limit disk cache size", false };
 		cfg::_int<0, 10240> cache_max_size{ this, "Disk cache maximum size (MB)", 5120 };
 		cfg::_bool empty_hdd0_tmp{ this, "Empty /dev_hdd0/tmp/", true };
+		cfg::_bool cache_metadata{ this, "Cache Read-Only File Metadata", true };
 
 	} vfs{ this };
 
@@ -146,18 +157,21 @@ struct cfg_root : cfg::node
 		cfg::_bool disable_video_output{ this, "Disable Video Output", false, true };
 		cfg::_bool disable_vertex_cache{ this, "Disable Vertex Cache", false };
 		cfg::_bool disable_FIFO_reordering{ this, "Disable FIFO Reordering", false };
+		cfg::_bool fifo_memoization{ this, "FIFO Command Memoization", false };
 		cfg::_bool frame_skip_enabled{ this, "Enable Frame Skip", false, true };
 		cfg::_bool force_cpu_blit_processing{ this, "Force CPU Blit", false, true }; // Debugging option
 		cfg::_bool disable_on_disk_shader_cache{ this, "Disable On-Disk Shader Cache", false };
 		cfg::_bool disable_vulkan_mem_allocator{ this, "Disable Vulkan Memory Allocator", false };
 		cfg::_bool full_rgb_range_output{ this, "Use full RGB output range", true, true }; // Video out dynamic range
 		cfg::_bool strict_texture_flushing{ this, "Strict Texture Flushing", false };
+		cfg::_bool zero_copy_linear_textures{ this, "Zero-copy Linear Texture Upload", false, true };
 #ifdef __APPLE__
 		cfg::_bool disable_native_float16{ this, "Disable native float16 support", true };
 #else
 		cfg::_bool disable_native_float16{ this, "Disable native float16 support", false };
 #endif
 		cfg::_bool multithreaded_rsx{ this, "Multithreaded RSX", false };
+		cfg::_bool parallel_vertex_upload{ this, "Parallel Vertex Upload", false, true };
 		cfg::_bool relaxed_zcull_sync{ this, "Relaxed ZCULL Sync", false };
 		cfg::_bool enable_3d{ this, "Enable 3D", false };
 		cfg::_bool debug_program_analyser{ this, "Debug Program Analyser", false };
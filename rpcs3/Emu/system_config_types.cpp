@@ -427,6 +427,7 @@ void fmt_class_string<pad_handler_mode>::format(std::string& out, u64 arg)
 		{
 		case pad_handler_mode::single_threaded: return "Single-threaded";
 		case pad_handler_mode::multi_threaded: return "Multi-threaded";
+		case pad_handler_mode::event_driven: return "Event-driven";
 		}
 
 		return unknown;
@@ -163,7 +163,8 @@ enum class microphone_handler
 enum class pad_handler_mode
 {
 	single_threaded, // All pad handlers run on the same thread sequentially.
-	multi_threaded   // Each pad handler has its own thread.
+	multi_threaded,  // Each pad handler has its own thread.
+	event_driven     // Each pad handler has its own thread which wakes up on device input if supported (evdev). Falls back to polling otherwise.
 };
 
 enum class video_resolution
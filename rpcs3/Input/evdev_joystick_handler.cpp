@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <unistd.h>
 #include <fcntl.h>
+#include <sys/epoll.h>
 #include <errno.h>
 #include <cstring>
 #include <cstdio>
@@ -176,6 +177,10 @@ bool evdev_joystick_handler::update_device(const std::shared_ptr<PadDevice>& dev
 		return false;
 	}
 
+	// Use event timestamps that are comparable to steady_clock for the input latency measurement
+	libevdev_set_clock_id(dev, CLOCK_MONOTONIC);
+	m_epoll_dirty = true;
+
 	evdev_log.notice("Opened joystick: '%s' at %s (fd %d)", get_device_name(dev), path, fd);
 	return true;
 }
@@ -206,6 +211,12 @@ void evdev_joystick_handler::Close()
 			}
 		}
 	}
+
+	if (m_epoll_fd >= 0)
+	{
+		close(m_epoll_fd);
+		m_epoll_fd = -1;
+	}
 }
 
 std::unordered_map<u64, std::pair<u16, bool>> evdev_joystick_handler::GetButtonValues(const std::shared_ptr<EvdevDevice>& device)
@@ -710,6 +721,8 @@ int evdev_joystick_handler::add_device(const std::string& device, const std::sha
 					}
 				}
 
+				libevdev_set_clock_id(dev, CLOCK_MONOTONIC);
+
 				// Alright, now that we've confirmed we haven't added this joystick yet, les do dis.
 				m_dev->device     = dev;
 				m_dev->path       = path;
@@ -835,6 +848,11 @@ void evdev_joystick_handler::handle_input_event(const input_event& evt, const st
 			tmp.m_value = pad->m_pressure_intensity;
 		}
 
+		if (tmp.m_value != button.m_value || tmp.m_pressed != button.m_pressed)
+		{
+			pad->stamp_input(get_event_timestamp(evt));
+		}
+
 		button = tmp;
 	}
 
@@ -908,12 +926,93 @@ void evdev_joystick_handler::handle_input_event(const input_event& evt, const st
 	convert_stick_values(lx, ly, m_dev->stick_val[0], m_dev->stick_val[1], cfg->lstickdeadzone, cfg->lpadsquircling);
 	convert_stick_values(rx, ry, m_dev->stick_val[2], m_dev->stick_val[3], cfg->rstickdeadzone, cfg->rpadsquircling);
 
+	if (pad->m_sticks[0].m_value != lx || pad->m_sticks[1].m_value != 255 - ly || pad->m_sticks[2].m_value != rx || pad->m_sticks[3].m_value != 255 - ry)
+	{
+		pad->stamp_input(get_event_timestamp(evt));
+	}
+
 	pad->m_sticks[0].m_value = lx;
 	pad->m_sticks[1].m_value = 255 - ly;
 	pad->m_sticks[2].m_value = rx;
 	pad->m_sticks[3].m_value = 255 - ry;
 }
 
+u64 evdev_joystick_handler::get_event_timestamp(const input_event& evt)
+{
+	// The device clock was switched to CLOCK_MONOTONIC, which is the clock used by steady_clock
+	return static_cast<u64>(evt.time.tv_sec) * 1'000'000 + evt.time.tv_usec;
+}
+
+bool evdev_joystick_handler::wait_for_input(u64 timeout_us)
+{
+	std::vector<int> fds;
+
+	for (const auto& binding : bindings)
+	{
+		const EvdevDevice* evdev_device = static_cast<EvdevDevice*>(binding.first.get());
+
+		if (evdev_device && evdev_device->device)
+		{
+			fds.push_back(libevdev_get_fd(evdev_device->device));
+		}
+	}
+
+	// Closed fds are removed from the epoll set automatically, but a reopened device may reuse the same fd number
+	if (m_epoll_fd < 0 || m_epoll_dirty || fds != m_epoll_fds)
+	{
+		if (m_epoll_fd >= 0)
+		{
+			close(m_epoll_fd);
+		}
+
+		m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+		m_epoll_fds.clear();
+		m_epoll_dirty = false;
+
+		if (m_epoll_fd < 0)
+		{
+			const int err = errno;
+			evdev_log.error("epoll_create1 failed: %s [errno %d]", strerror(err), err);
+			return false;
+		}
+
+		for (const int fd : fds)
+		{
+			epoll_event ev{};
+			ev.events = EPOLLIN;
+			ev.data.fd = fd;
+
+			if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1)
+			{
+				const int err = errno;
+				evdev_log.error("epoll_ctl failed for fd %d: %s [errno %d]", fd, strerror(err), err);
+			}
+		}
+
+		// Keep the full list so that a failed registration doesn't rebuild the set on every call
+		m_epoll_fds = fds;
+	}
+
+	if (fds.empty())
+	{
+		// Nothing to wait on. Let the caller sleep.
+		return false;
+	}
+
+	std::array<epoll_event, MAX_GAMEPADS> events{};
+	const int res = epoll_wait(m_epoll_fd, events.data(), ::size32(events), static_cast<int>(std::max<u64>(timeout_us / 1000, 1)));
+
+	if (res < 0 && errno != EINTR)
+	{
+		const int err = errno;
+		evdev_log.error("epoll_wait failed: %s [errno %d]", strerror(err), err);
+		m_epoll_dirty = true;
+		return false;
+	}
+
+	return true;
+}
+
 void evdev_joystick_handler::apply_pad_data(const std::shared_ptr<PadDevice>& device, const std::shared_ptr<Pad>& pad)
 {
 	EvdevDevice* evdev_device = static_cast<EvdevDevice*>(device.get());
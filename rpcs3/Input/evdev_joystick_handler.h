@@ -366,6 +366,7 @@ public:
 	void Close();
 	void get_next_button_press(const std::string& padId, const pad_callback& callback, const pad_fail_callback& fail_callback, bool get_blacklist = false, const std::vector<std::string>& buttons = {}) override;
 	void SetPadData(const std::string& padId, u8 player_id, u32 largeMotor, u32 smallMotor, s32 r, s32 g, s32 b, bool battery_led, u32 battery_led_brightness) override;
+	bool wait_for_input(u64 timeout_us) override;
 
 private:
 	std::shared_ptr<EvdevDevice> get_evdev_device(const std::string& device);
@@ -393,6 +394,12 @@ private:
 	bool check_buttons(const std::vector<EvdevButton>& b, const u32 code);
 
 	void handle_input_event(const input_event& evt, const std::shared_ptr<Pad>& pad);
+	static u64 get_event_timestamp(const input_event& evt);
+
+	// epoll set of the bound device fds, used by the event-driven pad handler mode
+	int m_epoll_fd = -1;
+	std::vector<int> m_epoll_fds;
+	bool m_epoll_dirty = false;
 
 protected:
 	PadHandlerBase::connection update_connection(const std::shared_ptr<PadDevice>& device) override;
@@ -82,6 +82,8 @@ void pad_thread::Init()
 		}
 	}
 
+	log_input_latency();
+
 	num_ldd_pad = 0;
 
 	m_info.now_connect = 0;
@@ -261,6 +263,12 @@ void pad_thread::operator()()
 
 					handler->ThreadProc();
 
+					// Sleep until the next device event arrives. Output data (rumble, LEDs) is applied at least once per frame.
+					if (pad_mode == pad_handler_mode::event_driven && handler->wait_for_input(16'000))
+					{
+						continue;
+					}
+
 					thread_ctrl::wait_for(g_cfg.io.pad_sleep);
 				}
 			}));
@@ -356,6 +364,23 @@ void pad_thread::operator()()
 	}
 
 	stop_threads();
+
+	std::lock_guard lock(pad::g_pad_mutex);
+	log_input_latency();
+}
+
+void pad_thread::log_input_latency() const
+{
+	for (u32 i = 0; i < CELL_PAD_MAX_PORT_NUM; i++)
+	{
+		if (!m_pads[i] || !m_pads[i]->m_latency.samples)
+		{
+			continue;
+		}
+
+		const pad_latency_stats& stats = m_pads[i]->m_latency;
+		input_log.notice("Pad %d: input latency: avg=%dus, min=%dus, max=%dus, last=%dus (%d samples)", i, stats.average(), stats.min, stats.max, stats.last, stats.samples);
+	}
 }
 
 void pad_thread::InitLddPad(u32 handle)
@@ -40,6 +40,7 @@ public:
 protected:
 	void Init();
 	void InitLddPad(u32 handle);
+	void log_input_latency() const; // Requires pad::g_pad_mutex
 
 	// List of all handlers
 	std::map<pad_handler, std::shared_ptr<PadHandlerBase>> handlers;
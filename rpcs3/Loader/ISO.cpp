@@ -0,0 +1,681 @@
+#include "stdafx.h"
+
+#include "ISO.h"
+
+#include "Utilities/StrUtil.h"
+#include "Utilities/mutex.h"
+#include "util/asm.hpp"
+
+#include <chrono>
+
+LOG_CHANNEL(iso_log, "ISO");
+
+namespace
+{
+	constexpr u64 iso_sector_size = 2048;
+	constexpr u32 iso_first_descriptor = 16;
+
+	// Directory record flags
+	constexpr u8 iso_flag_directory = 0x02;
+	constexpr u8 iso_flag_multi_extent = 0x80;
+
+	// Directory record size without the file identifier
+	constexpr usz iso_record_size = 33;
+
+	u16 read_le16(const u8* ptr)
+	{
+		return static_cast<u16>(ptr[0] | ptr[1] << 8);
+	}
+
+	u32 read_le32(const u8* ptr)
+	{
+		return ptr[0] | ptr[1] << 8 | ptr[2] << 16 | static_cast<u32>(ptr[3]) << 24;
+	}
+
+	// Convert 7-byte recording date to UNIX time
+	s64 read_iso_time(const u8* ptr)
+	{
+		using namespace std::chrono;
+
+		const year_month_day date{year{1900 + ptr[0]}, month{ptr[1]}, day{ptr[2]}};
+
+		if (!date.ok())
+		{
+			return 0;
+		}
+
+		// The last byte is the offset from GMT in 15 minute intervals
+		const s64 offset = static_cast<s8>(ptr[6]) * 15 * 60;
+
+		return sys_days{date}.time_since_epoch().count() * 86400 + ptr[3] * 3600 + ptr[4] * 60 + ptr[5] - offset;
+	}
+
+	// Normalize path relative to the image root to the index key
+	std::string make_iso_key(std::string_view path)
+	{
+		std::vector<std::string> parts;
+
+		for (std::string& part : fmt::split(path, {"/", "\\"}))
+		{
+			if (part == ".")
+			{
+				continue;
+			}
+
+			if (part == "..")
+			{
+				if (!parts.empty())
+				{
+					parts.pop_back();
+				}
+
+				continue;
+			}
+
+			parts.emplace_back(fmt::to_lower(part));
+		}
+
+		return fmt::merge(parts, "/");
+	}
+}
+
+iso_archive::iso_archive(fs::file&& file)
+	: m_file(std::move(file))
+{
+	if (!is_file_iso(m_file))
+	{
+		return;
+	}
+
+	// Prefer the Joliet tree for its long names, fall back to the primary volume descriptor
+	std::array<u8, iso_sector_size> descriptor{};
+	std::array<u8, 34> root_record{};
+	bool found = false;
+	bool joliet = false;
+
+	for (u32 sector = iso_first_descriptor; sector < iso_first_descriptor + 32; sector++)
+	{
+		if (m_file.read_at(sector * iso_sector_size, descriptor.data(), descriptor.size()) != descriptor.size() || std::memcmp(descriptor.data() + 1, "CD001", 5) != 0)
+		{
+			break;
+		}
+
+		const u8 type = descriptor[0];
+
+		if (type == 255)
+		{
+			// Volume descriptor set terminator
+			break;
+		}
+
+		const bool is_joliet = type == 2 && descriptor[88] == 0x25 && descriptor[89] == 0x2f && (descriptor[90] == 0x40 || descriptor[90] == 0x43 || descriptor[90] == 0x45);
+
+		if ((type == 1 && !found) || is_joliet)
+		{
+			std::memcpy(root_record.data(), descriptor.data() + 156, root_record.size());
+			m_block_size = read_le16(descriptor.data() + 128);
+			found = true;
+			joliet = is_joliet;
+		}
+
+		if (is_joliet)
+		{
+			break;
+		}
+	}
+
+	if (!found || !m_block_size || m_block_size % 512)
+	{
+		iso_log.error("No valid volume descriptor found (block_size=%u)", m_block_size);
+		return;
+	}
+
+	iso_entry& root = m_entries.emplace_back();
+	root.stat.is_directory = true;
+	root.stat.size = read_le32(root_record.data() + 10);
+	root.stat.mtime = read_iso_time(root_record.data() + 18);
+	root.stat.atime = root.stat.mtime;
+	root.stat.ctime = root.stat.mtime;
+	root.extents.push_back({u64{read_le32(root_record.data() + 2)} * m_block_size, root.stat.size});
+	m_index.emplace("", 0);
+
+	std::vector<std::pair<u32, std::string>> queue{{0, {}}};
+	std::unordered_set<u64> visited{root.extents[0].pos};
+
+	for (usz i = 0; i < queue.size(); i++)
+	{
+		// Copy the key, read_dir appends to the queue
+		const auto [index, key] = queue[i];
+
+		if (!read_dir(index, key, joliet, queue, visited))
+		{
+			m_entries.clear();
+			m_index.clear();
+			return;
+		}
+	}
+
+	iso_log.notice("Loaded %u entries (joliet=%d, block_size=%u)", m_entries.size(), joliet, m_block_size);
+}
+
+bool iso_archive::read_dir(u32 dir_index, const std::string& dir_key, bool joliet, std::vector<std::pair<u32, std::string>>& queue, std::unordered_set<u64>& visited)
+{
+	const iso_extent extent = m_entries[dir_index].extents[0];
+
+	// Sanity limit, PS3 discs don't come close to it
+	if (extent.size > 0x1000'0000)
+	{
+		iso_log.error("Directory too large: '%s' (0x%x)", dir_key, extent.size);
+		return false;
+	}
+
+	std::vector<u8> data(extent.size);
+
+	if (m_file.read_at(extent.pos, data.data(), data.size()) != data.size())
+	{
+		iso_log.error("Failed to read directory '%s' (pos=0x%x, size=0x%x)", dir_key, extent.pos, extent.size);
+		return false;
+	}
+
+	// Entry which has more extents following it (multi-extent files)
+	u32 continued = umax;
+
+	for (usz pos = 0; pos < data.size();)
+	{
+		const u8* record = data.data() + pos;
+		const u8 length = record[0];
+
+		if (!length)
+		{
+			// Records don't cross block boundaries, the rest of the block is padding
+			pos = utils::align<usz>(pos + 1, m_block_size);
+			continue;
+		}
+
+		const u8 name_length = record[32];
+
+		if (length < iso_record_size || pos + length > data.size() || iso_record_size + name_length > length)
+		{
+			iso_log.error("Invalid directory record in '%s' (pos=0x%x, length=%u)", dir_key, pos, length);
+			return false;
+		}
+
+		pos += length;
+
+		if (name_length == 1 && (record[33] == 0 || record[33] == 1))
+		{
+			// Skip "." and ".."
+			continue;
+		}
+
+		const u8 flags = record[25];
+		const bool is_dir = (flags & iso_flag_directory) != 0;
+		const iso_extent data_extent{u64{read_le32(record + 2)} * m_block_size, read_le32(record + 10)};
+
+		std::string name;
+
+		if (joliet)
+		{
+			std::u16string name16(name_length / 2, u'\0');
+
+			for (usz i = 0; i < name16.size(); i++)
+			{
+				name16[i] = static_cast<char16_t>(record[33 + i * 2] << 8 | record[34 + i * 2]);
+			}
+
+			name = utf16_to_utf8(name16);
+		}
+		else
+		{
+			name.assign(reinterpret_cast<const char*>(record + 33), name_length);
+		}
+
+		// Strip file version and empty extension
+		if (const usz ver = name.find(';'); ver != umax)
+		{
+			name.resize(ver);
+		}
+
+		if (!is_dir && name.ends_with('.'))
+		{
+			name.pop_back();
+		}
+
+		if (continued != umax && m_entries[continued].name == name)
+		{
+			iso_entry& entry = m_entries[continued];
+			entry.extents.push_back(data_extent);
+			entry.stat.size += data_extent.size;
+
+			if (!(flags & iso_flag_multi_extent))
+			{
+				continued = umax;
+			}
+
+			continue;
+		}
+
+		continued = umax;
+
+		if (is_dir && !visited.emplace(data_extent.pos).second)
+		{
+			// Malformed images may link directories in cycles
+			iso_log.error("Directory '%s' in '%s' was already visited", name, dir_key);
+			continue;
+		}
+
+		const std::string key = dir_key.empty() ? fmt::to_lower(name) : dir_key + '/' + fmt::to_lower(name);
+		const u32 index = ::size32(m_entries);
+
+		if (!m_index.emplace(key, index).second)
+		{
+			iso_log.warning("Duplicate entry ignored: '%s'", key);
+			continue;
+		}
+
+		iso_entry& entry = m_entries.emplace_back();
+		entry.name = std::move(name);
+		entry.stat.is_directory = is_dir;
+		entry.stat.size = data_extent.size;
+		entry.stat.mtime = read_iso_time(record + 18);
+		entry.stat.atime = entry.stat.mtime;
+		entry.stat.ctime = entry.stat.mtime;
+		entry.extents.push_back(data_extent);
+
+		m_entries[dir_index].children.push_back(index);
+
+		if (is_dir)
+		{
+			queue.emplace_back(index, key);
+		}
+		else if (flags & iso_flag_multi_extent)
+		{
+			continued = index;
+		}
+	}
+
+	return true;
+}
+
+const iso_entry* iso_archive::find(std::string_view path) const
+{
+	if (const auto found = m_index.find(make_iso_key(path)); found != m_index.end())
+	{
+		return &m_entries[found->second];
+	}
+
+	return nullptr;
+}
+
+namespace
+{
+	class iso_file final : public fs::file_base
+	{
+		const std::shared_ptr<iso_archive> m_archive;
+		const iso_entry& m_entry;
+		u64 m_pos = 0;
+
+	public:
+		iso_file(std::shared_ptr<iso_archive> archive, const iso_entry& entry)
+			: m_archive(std::move(archive))
+			, m_entry(entry)
+		{
+		}
+
+		fs::stat_t stat() override
+		{
+			return m_entry.stat;
+		}
+
+		bool trunc(u64) override
+		{
+			fs::g_tls_error = fs::error::readonly;
+			return false;
+		}
+
+		u64 read(void* buffer, u64 size) override
+		{
+			const u64 result = read_at(m_pos, buffer, size);
+			m_pos += result;
+			return result;
+		}
+
+		u64 read_at(u64 offset, void* buffer, u64 size) override
+		{
+			u64 result = 0;
+			u64 extent_start = 0;
+
+			for (const iso_extent& extent : m_entry.extents)
+			{
+				if (result == size)
+				{
+					break;
+				}
+
+				const u64 extent_end = extent_start + extent.size;
+
+				if (offset + result < extent_end)
+				{
+					const u64 extent_offset = offset + result - extent_start;
+					const u64 count = std::min(size - result, extent.size - extent_offset);
+					const u64 nread = m_archive->file().read_at(extent.pos + extent_offset, static_cast<u8*>(buffer) + result, count);
+
+					result += nread;
+
+					if (nread != count)
+					{
+						break;
+					}
+				}
+
+				extent_start = extent_end;
+			}
+
+			return result;
+		}
+
+		u64 write(const void*, u64) override
+		{
+			fs::g_tls_error = fs::error::readonly;
+			return 0;
+		}
+
+		u64 seek(s64 offset, fs::seek_mode whence) override
+		{
+			const s64 new_pos =
+				whence == fs::seek_set ? offset :
+				whence == fs::seek_cur ? offset + m_pos :
+				whence == fs::seek_end ? offset + size() : -1;
+
+			if (new_pos < 0)
+			{
+				fs::g_tls_error = fs::error::inval;
+				return -1;
+			}
+
+			m_pos = new_pos;
+			return m_pos;
+		}
+
+		u64 size() override
+		{
+			return m_entry.stat.size;
+		}
+	};
+
+	class iso_dir final : public fs::dir_base
+	{
+		std::vector<fs::dir_entry> m_entries;
+		usz m_pos = 0;
+
+	public:
+		iso_dir(const iso_archive& archive, const iso_entry& dir)
+		{
+			for (const char* name : {".", ".."})
+			{
+				fs::dir_entry& entry = m_entries.emplace_back();
+				static_cast<fs::stat_t&>(entry) = dir.stat;
+				entry.name = name;
+			}
+
+			for (u32 index : dir.children)
+			{
+				const iso_entry& child = archive.get(index);
+
+				fs::dir_entry& entry = m_entries.emplace_back();
+				static_cast<fs::stat_t&>(entry) = child.stat;
+				entry.name = child.name;
+			}
+		}
+
+		bool read(fs::dir_entry& out) override
+		{
+			if (m_pos < m_entries.size())
+			{
+				out = m_entries[m_pos++];
+				return true;
+			}
+
+			return false;
+		}
+
+		void rewind() override
+		{
+			m_pos = 0;
+		}
+	};
+
+	class iso_device final : public fs::device_base
+	{
+		const std::shared_ptr<iso_archive> m_archive;
+
+	public:
+		const std::string root;
+
+		iso_device(std::shared_ptr<iso_archive> archive, const std::string& name)
+			: m_archive(std::move(archive))
+			, root(fs_prefix + name)
+		{
+		}
+
+		const iso_entry* find(const std::string& path) const
+		{
+			if (!path.starts_with(root) || (path.size() > root.size() && path[root.size()] != '/' && path[root.size()] != '\\'))
+			{
+				fs::g_tls_error = fs::error::noent;
+				return nullptr;
+			}
+
+			if (const iso_entry* entry = m_archive->find(std::string_view(path).substr(root.size())))
+			{
+				return entry;
+			}
+
+			fs::g_tls_error = fs::error::noent;
+			return nullptr;
+		}
+
+		bool stat(const std::string& path, fs::stat_t& info) override
+		{
+			if (const iso_entry* entry = find(path))
+			{
+				info = entry->stat;
+				return true;
+			}
+
+			return false;
+		}
+
+		bool statfs(const std::string& path, fs::device_stat& info) override
+		{
+			if (!find(path))
+			{
+				return false;
+			}
+
+			info.block_size = m_archive->block_size();
+			info.total_size = m_archive->file().size();
+			info.total_free = 0;
+			info.avail_free = 0;
+			return true;
+		}
+
+		std::unique_ptr<fs::file_base> open(const std::string& path, bs_t<fs::open_mode> mode) override
+		{
+			if (mode & (fs::write + fs::append + fs::create + fs::trunc))
+			{
+				fs::g_tls_error = fs::error::readonly;
+				return nullptr;
+			}
+
+			const iso_entry* entry = find(path);
+
+			if (!entry)
+			{
+				return nullptr;
+			}
+
+			if (entry->stat.is_directory)
+			{
+				fs::g_tls_error = fs::error::isdir;
+				return nullptr;
+			}
+
+			return std::make_unique<iso_file>(m_archive, *entry);
+		}
+
+		std::unique_ptr<fs::dir_base> open_dir(const std::string& path) override
+		{
+			const iso_entry* entry = find(path);
+
+			if (!entry)
+			{
+				return nullptr;
+			}
+
+			if (!entry->stat.is_directory)
+			{
+				fs::g_tls_error = fs::error::noent;
+				return nullptr;
+			}
+
+			return std::make_unique<iso_dir>(*m_archive, *entry);
+		}
+	};
+
+	struct iso_mount_list
+	{
+		shared_mutex mutex;
+		std::vector<std::pair<std::string, std::string>> mounts; // Image path and root directory
+	};
+
+	iso_mount_list& get_iso_mounts()
+	{
+		static iso_mount_list list;
+		return list;
+	}
+}
+
+bool is_file_iso(const fs::file& file)
+{
+	if (!file || file.size() < (iso_first_descriptor + 1) * iso_sector_size)
+	{
+		return false;
+	}
+
+	std::array<u8, 6> magic{};
+	return file.read_at(iso_first_descriptor * iso_sector_size, magic.data(), magic.size()) == magic.size() && std::memcmp(magic.data() + 1, "CD001", 5) == 0;
+}
+
+bool is_file_iso(const std::string& path)
+{
+	if (path.empty() || fs::is_dir(path))
+	{
+		return false;
+	}
+
+	return is_file_iso(fs::file(path));
+}
+
+std::string iso_mount(const std::string& image_path)
+{
+	auto& list = get_iso_mounts();
+
+	std::lock_guard lock(list.mutex);
+
+	for (const auto& [image, root] : list.mounts)
+	{
+		if (image == image_path)
+		{
+			return root;
+		}
+	}
+
+	auto archive = std::make_shared<iso_archive>(fs::file(image_path));
+
+	if (!*archive)
+	{
+		iso_log.error("Failed to load image '%s'", image_path);
+		return {};
+	}
+
+	const std::string name = fmt::format("iso%u", list.mounts.size());
+	const shared_ptr<iso_device> device = make_single<iso_device>(std::move(archive), name);
+
+	if (!fs::set_virtual_device(name, device))
+	{
+		iso_log.error("Failed to mount image '%s' (%s)", image_path, fs::g_tls_error);
+		return {};
+	}
+
+	iso_log.notice("Mounted image '%s' at '%s'", image_path, device->root);
+	return list.mounts.emplace_back(image_path, device->root).second;
+}
+
+std::string resolve_iso_path(const std::string& path)
+{
+	if (!is_file_iso(path))
+	{
+		return path;
+	}
+
+	if (std::string root = iso_mount(path); !root.empty())
+	{
+		return root + '/';
+	}
+
+	return path;
+}
+
+// Find the image mounted at the root containing the path, also returns the path relative to the root
+static bool find_iso_mount(std::string_view path, std::string& image, std::string_view& rest)
+{
+	auto& list = get_iso_mounts();
+
+	reader_lock lock(list.mutex);
+
+	for (const auto& [mounted, root] : list.mounts)
+	{
+		if (!path.starts_with(root) || (path.size() > root.size() && path[root.size()] != '/'))
+		{
+			continue;
+		}
+
+		image = mounted;
+		rest = path.substr(root.size());
+		return true;
+	}
+
+	return false;
+}
+
+std::string iso_host_path(std::string_view path)
+{
+	std::string image;
+	std::string_view rest;
+
+	if (!find_iso_mount(path, image, rest))
+	{
+		return std::string(path);
+	}
+
+	if (rest.find_first_not_of('/') == umax)
+	{
+		return image;
+	}
+
+	return image + std::string(rest);
+}
+
+std::string iso_image_path(std::string_view path)
+{
+	std::string image;
+	std::string_view rest;
+
+	if (!find_iso_mount(path, image, rest))
+	{
+		return std::string(path);
+	}
+
+	return image;
+}
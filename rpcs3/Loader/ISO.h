@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Utilities/File.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+struct iso_extent
+{
+	u64 pos; // Byte offset in the image
+	u64 size;
+};
+
+struct iso_entry
+{
+	std::string name;
+	fs::stat_t stat{};
+	std::vector<iso_extent> extents; // Files larger than 4GB are stored in multiple extents
+	std::vector<u32> children; // Indices of directory entries
+};
+
+// Read-only ISO 9660 image, the directory tree is indexed once on construction
+class iso_archive
+{
+	fs::file m_file;
+	u32 m_block_size = 2048;
+	std::vector<iso_entry> m_entries; // Root directory is the first entry
+	std::unordered_map<std::string, u32> m_index; // Maps lowercase path (without leading slash) to entry
+
+	bool read_dir(u32 dir_index, const std::string& dir_key, bool joliet, std::vector<std::pair<u32, std::string>>& queue, std::unordered_set<u64>& visited);
+
+public:
+	explicit iso_archive(fs::file&& file);
+
+	// Check whether the directory tree was loaded
+	explicit operator bool() const
+	{
+		return !m_entries.empty();
+	}
+
+	// Get entry for a path relative to the image root, nullptr if not found
+	const iso_entry* find(std::string_view path) const;
+
+	const iso_entry& get(u32 index) const
+	{
+		return m_entries[index];
+	}
+
+	const fs::file& file() const
+	{
+		return m_file;
+	}
+
+	u32 block_size() const
+	{
+		return m_block_size;
+	}
+};
+
+// Check whether the file has an ISO 9660 volume descriptor
+bool is_file_iso(const fs::file& file);
+bool is_file_iso(const std::string& path);
+
+// Mount the image as a read-only virtual device (only once per image), returns the path of its root directory or an empty string on failure
+std::string iso_mount(const std::string& image_path);
+
+// If the path is an image, mount it and return its root directory with a trailing slash, otherwise return the path unchanged
+std::string resolve_iso_path(const std::string& path);
+
+// If the path points into a mounted image, replace the root directory with the image path, otherwise return the path unchanged
+std::string iso_host_path(std::string_view path);
+
+// If the path points into a mounted image, return the image path (bootable in later sessions), otherwise return the path unchanged
+std::string iso_image_path(std::string_view path);
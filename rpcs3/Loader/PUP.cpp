@@ -2,8 +2,18 @@
 
 #include "Crypto/sha1.h"
 #include "Crypto/key_vault.h"
+#include "Crypto/unself.h"
+
+#include "Emu/VFS.h"
+#include "Emu/vfs_config.h"
+
+#include "Utilities/Thread.h"
+#include "util/sysinfo.hpp"
 
 #include "PUP.h"
+#include "TAR.h"
+
+LOG_CHANNEL(pup_log, "PUP");
 
 pup_object::pup_object(fs::file&& file) : m_file(std::move(file))
 {
@@ -113,3 +123,179 @@ pup_error pup_object::validate_hashes()
 
 	return pup_error::ok;
 }
+
+pup_install_error pup_install_packages(tar_object& update_files, const std::vector<std::string>& packages, atomic_t<u32>& progress)
+{
+	const u32 count = ::size32(packages);
+
+	// tar_object is not thread-safe
+	std::mutex tar_mutex;
+
+	// Next package to decrypt
+	atomic_t<u32> next = 0;
+
+	// Next package to extract, packages are extracted in order so that the result doesn't depend on timing
+	atomic_t<u32> turn = 0;
+
+	atomic_t<pup_install_error> result = pup_install_error::ok;
+
+	const auto fail = [&](pup_install_error error)
+	{
+		result.compare_and_swap(pup_install_error::ok, error);
+		progress = -1;
+	};
+
+	named_thread_group workers("Firmware Installer ", std::min<u32>(utils::get_thread_count(), count), [&]()
+	{
+		for (u32 i = next++; i < count && progress != umax; i = next++)
+		{
+			const std::string& package_name = packages[i];
+
+			fs::file package;
+			{
+				std::lock_guard lock(tar_mutex);
+				package = update_files.get_file(package_name);
+			}
+
+			SCEDecrypter self_dec(package);
+			self_dec.LoadHeaders();
+			self_dec.LoadMetadata(SCEPKG_ERK, SCEPKG_RIV);
+			self_dec.DecryptData();
+
+			auto dev_flash_tar_f = self_dec.MakeFile();
+
+			if (dev_flash_tar_f.size() < 3)
+			{
+				pup_log.error("Failed to decrypt firmware package %s", package_name);
+				fail(pup_install_error::decrypt);
+				return;
+			}
+
+			// Wait until all previous packages have been extracted
+			for (u32 value = turn; value != i; value = turn)
+			{
+				if (progress == umax)
+				{
+					return;
+				}
+
+				turn.wait(value, atomic_wait_timeout{1'000'000});
+			}
+
+			tar_object dev_flash_tar(dev_flash_tar_f[2]);
+
+			if (!dev_flash_tar.extract())
+			{
+				pup_log.error("Failed to extract firmware package %s", package_name);
+				fail(pup_install_error::extract);
+				return;
+			}
+
+			pup_log.notice("Installed firmware package %s", package_name);
+
+			if (!progress.try_inc(count))
+			{
+				// Installation was cancelled
+				return;
+			}
+
+			turn++;
+			turn.notify_all();
+		}
+	});
+
+	workers.join();
+
+	if (const pup_install_error error = result; error != pup_install_error::ok)
+	{
+		return error;
+	}
+
+	return progress == count ? pup_install_error::ok : pup_install_error::cancelled;
+}
+
+bool pup_install_firmware(const std::string& path)
+{
+	fs::file pup_f(path);
+
+	if (!pup_f)
+	{
+		pup_log.error("Failed to open firmware file %s (%s)", path, fs::g_tls_error);
+		return false;
+	}
+
+	pup_object pup(std::move(pup_f));
+
+	if (pup_error error = static_cast<pup_error>(pup); error != pup_error::ok)
+	{
+		pup_log.error("Failed to open firmware file %s (error=%u) %s", path, static_cast<u32>(error), pup.get_formatted_error());
+		return false;
+	}
+
+	fs::file update_files_f = pup.get_file(0x300);
+
+	if (!update_files_f)
+	{
+		pup_log.error("Couldn't find installation packages database in %s", path);
+		return false;
+	}
+
+	tar_object update_files(update_files_f);
+
+	auto packages = update_files.get_filenames();
+
+	std::erase_if(packages, [](const std::string& s) { return s.find("dev_flash_") == umax; });
+
+	if (packages.empty())
+	{
+		pup_log.error("No dev_flash_* packages were found in %s", path);
+		return false;
+	}
+
+	std::string version_string;
+
+	if (fs::file version = pup.get_file(0x100))
+	{
+		version_string = version.to_string();
+	}
+
+	if (const usz version_pos = version_string.find('\n'); version_pos != umax)
+	{
+		version_string.erase(version_pos);
+	}
+
+	// Same checks as main_window::HandlePupInstallation, without the questions
+	if (version_string.empty())
+	{
+		pup_log.error("No version data was found in %s", path);
+		return false;
+	}
+
+	if (version_string < "4.89"sv)
+	{
+		pup_log.warning("Old firmware detected: the newest firmware version is 4.89, installing version %s", version_string);
+	}
+
+	if (std::string installed = utils::get_firmware_version(); !installed.empty())
+	{
+		pup_log.warning("Reinstalling firmware: old=%s, new=%s", installed, version_string);
+	}
+
+	// Used by tar_object::extract() as destination directory
+	if (!vfs::mount("/dev_flash", g_cfg_vfs.get_dev_flash()))
+	{
+		pup_log.error("Failed to mount /dev_flash");
+		return false;
+	}
+
+	atomic_t<u32> progress = 0;
+
+	if (pup_install_packages(update_files, packages, progress) != pup_install_error::ok)
+	{
+		pup_log.error("Failed to install firmware version %s from %s", version_string, path);
+		return false;
+	}
+
+	pup_log.success("Successfully installed PS3 firmware version %s.", version_string);
+	return true;
+}
@@ -1,10 +1,14 @@
 #pragma once
 
 #include "util/types.hpp"
+#include "util/atomic.hpp"
 #include "../../Utilities/File.h"
 
+#include <string>
 #include <vector>
 
+class tar_object;
+
 struct PUPHeader
 {
 	le_t<u64> magic;
@@ -64,3 +68,21 @@ public:
 
 	fs::file get_file(u64 entry_id) const;
 };
+
+// Firmware installation error
+enum class pup_install_error : u32
+{
+	ok,
+
+	decrypt, // A dev_flash package could not be decrypted
+	extract, // A dev_flash package could not be extracted
+	cancelled,
+};
+
+// Install the given dev_flash_* packages of the update files (PUP entry 0x300) to the mounted /dev_flash
+// Packages are decrypted by several threads, and extracted one at a time in the given order
+// progress counts installed packages, setting it to umax from another thread cancels the installation
+pup_install_error pup_install_packages(tar_object& update_files, const std::vector<std::string>& packages, atomic_t<u32>& progress);
+
+// Install the firmware from the given PUP file without user interaction (for the command line)
+bool pup_install_firmware(const std::string& path);
@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "disc.h"
+#include "ISO.h"
 #include "PSF.h"
 #include "util/logs.hpp"
 #include "Utilities/StrUtil.h"
@@ -23,6 +24,9 @@ namespace disc
 			return disc_type::invalid;
 		}
 
+		// Disc images are inspected through their mounted root directory
+		path = resolve_iso_path(path);
+
 		if (!fs::is_dir(path))
 		{
 			disc_log.error("Can not determine disc type. Path not a directory: '%s'", path);
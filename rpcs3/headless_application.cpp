@@ -7,6 +7,7 @@
 #include "Emu/Cell/Modules/sceNpTrophy.h"
 #include "Emu/Io/Null/null_camera_handler.h"
 #include "Emu/Io/Null/null_music_handler.h"
+#include "Emu/perf_tuner.hpp"
 
 #include <clocale>
 
@@ -135,7 +136,7 @@ void headless_application::InitializeCallbacks()
 	callbacks.on_run    = [](bool /*start_playtime*/) {};
 	callbacks.on_pause  = []() {};
 	callbacks.on_resume = []() {};
-	callbacks.on_stop   = []() {};
+	callbacks.on_stop   = []() { g_perf_tuner.on_stop(); };
 	callbacks.on_ready  = []() {};
 
 	callbacks.enable_disc_eject  = [](bool) {};
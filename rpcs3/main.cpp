@@ -29,6 +29,7 @@
 #include "headless_application.h"
 #include "Utilities/sema.h"
 #include "Crypto/decrypt_binaries.h"
+#include "Loader/PUP.h"
 #ifdef _WIN32
 #include <windows.h>
 #include "util/dyn_lib.hpp"
@@ -67,6 +68,7 @@ DYNAMIC_IMPORT("ntdll.dll", NtSetTimerResolution, NTSTATUS(ULONG DesiredResoluti
 #include "rpcs3_version.h"
 #include "Emu/System.h"
 #include "Emu/system_utils.hpp"
+#include "Emu/perf_tuner.hpp"
 #include <thread>
 #include <charconv>
 
@@ -260,6 +262,8 @@ struct fatal_error_listener final : logs::listener
 constexpr auto arg_headless     = "headless";
 constexpr auto arg_decrypt      = "decrypt";
 constexpr auto arg_commit_db    = "get-commit-db";
+constexpr auto arg_tune         = "tune";
+constexpr auto arg_tune_frames  = "tune-frames";
 
 // Arguments that can be used with a gui application
 constexpr auto arg_no_gui       = "no-gui";
@@ -280,6 +284,26 @@ constexpr auto arg_timer        = "high-res-timer";
 constexpr auto arg_verbose_curl = "verbose-curl";
 constexpr auto arg_any_location = "allow-any-location";
 
+// Boot the title once per candidate config and save the fastest settings as its custom config
+static void start_perf_tuner(const std::string& path, const std::vector<std::string>& rpcs3_argv, u32 frames)
+{
+	g_perf_tuner.start(frames, [path, rpcs3_argv](const std::string& config_path)
+	{
+		Emu.argv = rpcs3_argv;
+		Emu.SetForceBoot(true);
+
+		const cfg_mode config_mode = config_path.empty() ? cfg_mode::custom : cfg_mode::custom_selection;
+
+		if (const game_boot_result error = Emu.BootGame(path, "", false, false, config_mode, config_path); error != game_boot_result::no_errors)
+		{
+			sys_log.error("Booting '%s' for performance tuning failed: reason: %s", path, error);
+			return false;
+		}
+
+		return true;
+	});
+}
+
 int find_arg(std::string arg, int& argc, char* argv[])
 {
 	arg = "--" + arg;
@@ -293,7 +317,8 @@ QCoreApplication* create_application(int& argc, char* argv[])
 {
 	if (find_arg(arg_headless, argc, argv) != -1 ||
 		find_arg(arg_decrypt, argc, argv) != -1 ||
-		find_arg(arg_commit_db, argc, argv) != -1)
+		find_arg(arg_commit_db, argc, argv) != -1 ||
+		find_arg(arg_tune, argc, argv) != -1)
 	{
 		return new headless_application(argc, argv);
 	}
@@ -623,6 +648,9 @@ int main(int argc, char** argv)
 	parser.addOption(QCommandLineOption(arg_timer, "Enable high resolution timer for better performance (windows)", "enabled", "1"));
 	parser.addOption(QCommandLineOption(arg_verbose_curl, "Enable verbose curl logging."));
 	parser.addOption(QCommandLineOption(arg_any_location, "Allow RPCS3 to be run from any location. Dangerous"));
+	parser.addOption(QCommandLineOption(arg_tune, "Search the fastest settings of the booted title or savestate in headless mode (measured with the Null renderer) and save them in its custom config."));
+	const QCommandLineOption tune_frames_option(arg_tune_frames, "Number of frames measured per candidate when tuning.", "frames", "1200");
+	parser.addOption(tune_frames_option);
 	parser.process(app->arguments());
 
 	// Don't start up the full rpcs3 gui if we just want the version or help.
@@ -1041,6 +1069,15 @@ int main(int argc, char** argv)
 		return 0;
 	}
 
+	// Install firmware without user interaction if there is no main window
+	if (parser.isSet(arg_installfw) && !parser.isSet(arg_installpkg) && (s_headless || s_no_gui))
+	{
+		Emu.Init();
+		const bool success = pup_install_firmware(parser.value(installfw_option).toStdString());
+		Emu.Quit(true);
+		return success ? 0 : 1;
+	}
+
 	// Force install firmware or pkg first if specified through command-line
 	if (parser.isSet(arg_installfw) || parser.isSet(arg_installpkg))
 	{
@@ -1082,6 +1119,19 @@ int main(int argc, char** argv)
 		sys_log.notice("Option passed via command line: %s %s", opt.toStdString(), parser.value(opt).toStdString());
 	}
 
+	u32 tune_frames = 0;
+
+	if (parser.isSet(arg_tune))
+	{
+		bool ok = false;
+		tune_frames = parser.value(tune_frames_option).toUInt(&ok);
+
+		if (!ok || !tune_frames)
+		{
+			report_fatal_error(fmt::format("Invalid number of frames for --%s: %s", arg_tune_frames, parser.value(tune_frames_option).toStdString()));
+		}
+	}
+
 	if (parser.isSet(arg_savestate))
 	{
 		const std::string savestate_path = parser.value(savestate_option).toStdString();
@@ -1092,8 +1142,14 @@ int main(int argc, char** argv)
 			report_fatal_error(fmt::format("No savestate file found: %s", savestate_path));
 		}
 
-		Emu.CallFromMainThread([path = savestate_path]()
+		Emu.CallFromMainThread([path = savestate_path, tune_frames]()
 		{
+			if (tune_frames)
+			{
+				start_perf_tuner(path, {}, tune_frames);
+				return;
+			}
+
 			Emu.SetForceBoot(true);
 
 			if (const game_boot_result error = Emu.BootGame(path); error != game_boot_result::no_errors)
@@ -1139,8 +1195,14 @@ int main(int argc, char** argv)
 		}
 
 		// Postpone startup to main event loop
-		Emu.CallFromMainThread([path = sstr(QFileInfo(args.at(0)).absoluteFilePath()), rpcs3_argv = std::move(rpcs3_argv), config_path = std::move(config_path)]() mutable
+		Emu.CallFromMainThread([path = sstr(QFileInfo(args.at(0)).absoluteFilePath()), rpcs3_argv = std::move(rpcs3_argv), config_path = std::move(config_path), tune_frames]() mutable
 		{
+			if (tune_frames)
+			{
+				start_perf_tuner(path, rpcs3_argv, tune_frames);
+				return;
+			}
+
 			Emu.argv = std::move(rpcs3_argv);
 			Emu.SetForceBoot(true);
 
@@ -154,6 +154,12 @@ EmuCallbacks main_application::CreateCallbacks()
 
 	callbacks.resolve_path = [](std::string_view sv)
 	{
+		// Paths inside mounted disc images only exist in fs virtual devices
+		if (std::string path(sv); fs::get_virtual_device(path))
+		{
+			return path;
+		}
+
 		return QFileInfo(QString::fromUtf8(sv.data(), static_cast<int>(sv.size()))).canonicalFilePath().toStdString();
 	};
 
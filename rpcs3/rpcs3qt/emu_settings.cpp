@@ -1040,6 +1040,7 @@ QString emu_settings::GetLocalizedSetting(const QString& original, emu_settings_
 		{
 		case pad_handler_mode::single_threaded: return tr("Single-threaded", "Pad handler mode");
 		case pad_handler_mode::multi_threaded: return tr("Multi-threaded", "Pad handler mode");
+		case pad_handler_mode::event_driven: return tr("Event-driven", "Pad handler mode");
 		}
 		break;
 	case emu_settings_type::Move:
@@ -21,6 +21,7 @@ struct gui_game_info
 	bool hasCustomPadConfig = false;
 	bool has_hover_gif = false;
 	movie_item* item = nullptr;
+	bool icon_requested = false; // The icon was queued for painting since the last repaint
 };
 
 typedef std::shared_ptr<gui_game_info> game_info;
@@ -0,0 +1,246 @@
+#include "stdafx.h"
+#include "game_list_cache.h"
+#include "gui_settings.h"
+
+#include "Utilities/File.h"
+#include "Loader/ISO.h"
+#include "util/yaml.hpp"
+
+#include <QImage>
+
+LOG_CHANNEL(game_list_log, "GameList");
+
+constexpr auto qstr = QString::fromStdString;
+
+// PNG text keys used to validate a thumbnail against its source
+static const QString s_source_key = QStringLiteral("RPCS3 Source");
+static const QString s_modified_key = QStringLiteral("RPCS3 Modified");
+
+game_list_cache::game_list_cache()
+	: m_dir(fs::get_cache_dir() + "game_list/")
+{
+	if (!fs::create_path(m_dir + "icons/"))
+	{
+		game_list_log.error("Failed to create path: %s (%s)", m_dir + "icons/", fs::g_tls_error);
+	}
+
+	load();
+}
+
+void game_list_cache::load()
+{
+	const std::string path = m_dir + "index.yml";
+	const fs::file file(path);
+
+	if (!file)
+	{
+		return;
+	}
+
+	auto [root, error] = yaml_load(file.to_string());
+
+	if (!error.empty())
+	{
+		game_list_log.error("Failed to load %s: %s", path, error);
+		m_dirty = true;
+		return;
+	}
+
+	for (const auto& node : root)
+	{
+		sfo_entry entry{};
+		entry.mtime = get_yaml_node_value<s64>(node.second["mtime"], error);
+		entry.size = get_yaml_node_value<u64>(node.second["size"], error);
+
+		for (const auto& value : node.second["strings"])
+		{
+			// Stored as [max size, value]
+			const u32 max_size = get_yaml_node_value<u32>(value.second[0], error);
+
+			if (!error.empty() || !max_size)
+			{
+				error = "invalid string entry " + value.first.Scalar();
+				break;
+			}
+
+			psf::assign(entry.psf, value.first.Scalar(), psf::string(max_size, value.second[1].Scalar()));
+		}
+
+		for (const auto& value : node.second["integers"])
+		{
+			psf::assign(entry.psf, value.first.Scalar(), get_yaml_node_value<u32>(value.second, error));
+		}
+
+		if (!error.empty())
+		{
+			// The entry will be recreated from the original file
+			game_list_log.warning("Dropped invalid game list cache entry %s: %s", node.first.Scalar(), error);
+			error.clear();
+			m_dirty = true;
+			continue;
+		}
+
+		m_entries.emplace(node.first.Scalar(), std::move(entry));
+	}
+
+	game_list_log.notice("Loaded %d entries from %s", m_entries.size(), path);
+}
+
+psf::registry game_list_cache::get_psf(const std::string& sfo_path)
+{
+	fs::stat_t stat{};
+
+	if (!fs::stat(sfo_path, stat) || stat.is_directory)
+	{
+		return {};
+	}
+
+	{
+		std::lock_guard lock(m_mutex);
+
+		if (const auto found = m_entries.find(sfo_path); found != m_entries.end() && found->second.mtime == stat.mtime && found->second.size == stat.size)
+		{
+			found->second.used = true;
+			return found->second.psf;
+		}
+	}
+
+	psf::registry psf = psf::load_object(fs::file(sfo_path));
+
+	// Binary arrays are not stored in the index, so drop them here as well to get the same result on the next run
+	std::erase_if(psf, [](const auto& entry)
+	{
+		return entry.second.type() == psf::format::array;
+	});
+
+	std::lock_guard lock(m_mutex);
+
+	sfo_entry& entry = m_entries[sfo_path];
+	entry.mtime = stat.mtime;
+	entry.size = stat.size;
+	entry.psf = psf;
+	entry.used = true;
+	m_dirty = true;
+
+	return psf;
+}
+
+QPixmap game_list_cache::get_icon(const std::string& icon_path) const
+{
+	fs::stat_t stat{};
+
+	if (icon_path.empty() || !fs::stat(icon_path, stat) || stat.is_directory)
+	{
+		return {};
+	}
+
+	// Paths inside mounted disc images change between sessions, identify them by the image path
+	const std::string host_path = iso_host_path(icon_path);
+	const QString source = qstr(host_path);
+	const QString modified = QString::number(stat.mtime);
+	const QString thumbnail_path = qstr(fmt::format("%sicons/%016x.png", m_dir, std::hash<std::string>()(host_path)));
+
+	QImage image;
+
+	if (image.load(thumbnail_path) && image.text(s_source_key) == source && image.text(s_modified_key) == modified)
+	{
+		return QPixmap::fromImage(image);
+	}
+
+	// Files inside mounted disc images can only be read through fs::file
+	const fs::file icon(icon_path);
+
+	if (!icon)
+	{
+		return {};
+	}
+
+	if (const std::vector<u8> data = icon.to_vector<u8>(); !image.loadFromData(data.data(), ::narrow<int>(data.size())))
+	{
+		return {};
+	}
+
+	// Custom icons may be much larger than the biggest icon we ever display
+	if (image.width() > gui::gl_icon_size_max.width() || image.height() > gui::gl_icon_size_max.height())
+	{
+		image = image.scaled(gui::gl_icon_size_max, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+	}
+
+	image.setText(s_source_key, source);
+	image.setText(s_modified_key, modified);
+
+	if (!image.save(thumbnail_path, "PNG"))
+	{
+		game_list_log.warning("Failed to save thumbnail %s for %s", thumbnail_path.toStdString(), icon_path);
+	}
+
+	return QPixmap::fromImage(image);
+}
+
+void game_list_cache::save()
+{
+	std::lock_guard lock(m_mutex);
+
+	for (auto it = m_entries.begin(); it != m_entries.end();)
+	{
+		if (!it->second.used)
+		{
+			// The game was removed or moved
+			it = m_entries.erase(it);
+			m_dirty = true;
+			continue;
+		}
+
+		it->second.used = false;
+		++it;
+	}
+
+	if (!m_dirty)
+	{
+		return;
+	}
+
+	YAML::Emitter out;
+	out << YAML::BeginMap;
+
+	for (const auto& [path, entry] : m_entries)
+	{
+		out << YAML::Key << path << YAML::Value << YAML::BeginMap;
+		out << YAML::Key << "mtime" << YAML::Value << entry.mtime;
+		out << YAML::Key << "size" << YAML::Value << entry.size;
+
+		out << YAML::Key << "strings" << YAML::Value << YAML::BeginMap;
+		for (const auto& [key, value] : entry.psf)
+		{
+			if (value.type() == psf::format::string)
+			{
+				out << YAML::Key << key << YAML::Value << YAML::Flow << YAML::BeginSeq << value.max() << value.as_string() << YAML::EndSeq;
+			}
+		}
+		out << YAML::EndMap;
+
+		out << YAML::Key << "integers" << YAML::Value << YAML::BeginMap;
+		for (const auto& [key, value] : entry.psf)
+		{
+			if (value.type() == psf::format::integer)
+			{
+				out << YAML::Key << key << YAML::Value << value.as_integer();
+			}
+		}
+		out << YAML::EndMap;
+
+		out << YAML::EndMap;
+	}
+
+	out << YAML::EndMap;
+
+	const std::string path = m_dir + "index.yml";
+
+	if (!fs::write_file(path, fs::rewrite, out.c_str(), out.size()))
+	{
+		game_list_log.error("Failed to write %s (%s)", path, fs::g_tls_error);
+		return;
+	}
+
+	m_dirty = false;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "util/types.hpp"
+#include "Loader/PSF.h"
+
+#include <QPixmap>
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/*
+	On-disk index of the game list. Keeps the parsed PARAM.SFO of every game and a scaled copy
+	of its icon in the cache directory, so that a refresh only needs to stat the original files.
+	Entries are invalidated when the modification time or size of the source file changes.
+*/
+class game_list_cache
+{
+public:
+	game_list_cache();
+
+	/** Returns the PSF registry of the given PARAM.SFO. Only reads the file if the cached entry is outdated. Thread-safe. */
+	psf::registry get_psf(const std::string& sfo_path);
+
+	/** Returns the icon at the given path, downscaled to the maximum icon size. Only decodes the file if the thumbnail is outdated. Thread-safe. */
+	QPixmap get_icon(const std::string& icon_path) const;
+
+	/** Removes entries which were not requested since the last call and writes the index if anything changed */
+	void save();
+
+private:
+	struct sfo_entry
+	{
+		s64 mtime = 0;
+		u64 size = 0;
+		psf::registry psf;
+		bool used = false;
+	};
+
+	std::string m_dir;
+	std::mutex m_mutex;
+	std::unordered_map<std::string, sfo_entry> m_entries;
+	bool m_dirty = false;
+
+	void load();
+};
@@ -13,6 +13,7 @@
 #include "gui_settings.h"
 #include "game_list.h"
 #include "game_list_grid.h"
+#include "game_list_cache.h"
 #include "patch_manager_dialog.h"
 
 #include "Emu/Memory/vm.h"
@@ -20,6 +21,7 @@
 #include "Emu/vfs_config.h"
 #include "Emu/system_utils.hpp"
 #include "Loader/PSF.h"
+#include "Loader/ISO.h"
 #include "util/types.hpp"
 #include "Utilities/File.h"
 #include "util/yaml.hpp"
@@ -49,6 +51,22 @@ extern atomic_t<bool> g_system_progress_canceled;
 
 inline std::string sstr(const QString& _in) { return _in.toStdString(); }
 
+// Names of the subdirectories (games) of a watched directory
+static QSet<QString> get_game_dirs(const QString& path)
+{
+	QSet<QString> result;
+
+	for (const auto& entry : fs::dir(sstr(path)))
+	{
+		if (entry.is_directory && entry.name != "." && entry.name != "..")
+		{
+			result.insert(qstr(entry.name));
+		}
+	}
+
+	return result;
+}
+
 game_list_frame::game_list_frame(std::shared_ptr<gui_settings> gui_settings, std::shared_ptr<emu_settings> emu_settings, std::shared_ptr<persistent_settings> persistent_settings, QWidget* parent)
 	: custom_dock_widget(tr("Game List"), parent)
 	, m_gui_settings(std::move(gui_settings))
@@ -104,6 +122,15 @@ game_list_frame::game_list_frame(std::shared_ptr<gui_settings> gui_settings, std
 
 	m_game_compat = new game_compatibility(m_gui_settings, this);
 
+	m_cache = std::make_unique<game_list_cache>();
+
+	// Refresh the list when games are added to or removed from the game directories
+	m_dir_refresh_timer = new QTimer(this);
+	m_dir_refresh_timer->setSingleShot(true);
+	m_dir_refresh_timer->setInterval(1000);
+
+	m_dir_watcher = new QFileSystemWatcher(this);
+
 	m_central_widget = new QStackedWidget(this);
 	m_central_widget->addWidget(m_game_list);
 	m_central_widget->addWidget(m_game_grid);
@@ -158,6 +185,22 @@ game_list_frame::game_list_frame(std::shared_ptr<gui_settings> gui_settings, std
 		}
 	});
 
+	connect(m_dir_watcher, &QFileSystemWatcher::directoryChanged, this, [this](const QString& path)
+	{
+		// Only react to games being added, removed or renamed, not to files or other changes in the directory
+		if (const auto found = m_watched_dirs.constFind(path); found == m_watched_dirs.cend() || *found != get_game_dirs(path))
+		{
+			m_dir_refresh_timer->start();
+		}
+	});
+	connect(m_dir_watcher, &QFileSystemWatcher::fileChanged, m_dir_refresh_timer, QOverload<>::of(&QTimer::start));
+	connect(m_dir_refresh_timer, &QTimer::timeout, this, [this]()
+	{
+		game_list_log.notice("Game directories changed. Refreshing game list...");
+		Refresh(true, false);
+	});
+
+	connect(m_game_list->verticalScrollBar(), &QScrollBar::valueChanged, this, &game_list_frame::LoadVisibleIcons);
 	connect(m_game_list, &QTableWidget::customContextMenuRequested, this, &game_list_frame::ShowContextMenu);
 	connect(m_game_list, &QTableWidget::itemSelectionChanged, this, &game_list_frame::ItemSelectionChangedSlot);
 	connect(m_game_list, &QTableWidget::itemDoubleClicked, this, &game_list_frame::doubleClickedSlot);
@@ -317,6 +360,7 @@ void game_list_frame::OnColClicked(int col)
 	m_gui_settings->SetValue(gui::gl_sortCol, col);
 
 	SortGameList();
+	LoadVisibleIcons();
 }
 
 // Get visibility of entries
@@ -504,6 +548,38 @@ void game_list_frame::Refresh(const bool from_drive, const bool scroll_after)
 		add_dir(_hdd + "game/", false);
 		add_dir(_hdd + "disc/", true);
 
+		if (const QStringList watched = m_dir_watcher->directories() + m_dir_watcher->files(); !watched.isEmpty())
+		{
+			m_dir_watcher->removePaths(watched);
+		}
+
+		m_watched_dirs.clear();
+
+		for (const std::string& dir : { _hdd + "game/", _hdd + "disc/" })
+		{
+			if (fs::is_dir(dir))
+			{
+				m_dir_watcher->addPath(qstr(dir));
+				m_watched_dirs[qstr(dir)] = get_game_dirs(qstr(dir));
+			}
+		}
+
+		// Also refresh when the PARAM.SFO of one of these games changes (e.g. updated by a game patch)
+		QStringList sfo_paths;
+
+		for (const std::string& path : m_path_list)
+		{
+			if (const std::string sfo_path = rpcs3::utils::get_sfo_dir_from_game_path(path) + "/PARAM.SFO"; fs::is_file(sfo_path))
+			{
+				sfo_paths.push_back(qstr(sfo_path));
+			}
+		}
+
+		if (!sfo_paths.isEmpty())
+		{
+			m_dir_watcher->addPaths(sfo_paths);
+		}
+
 		auto get_games = []() -> YAML::Node
 		{
 			if (const fs::file games = fs::file(fs::get_config_dir() + "/games.yml", fs::read + fs::create))
@@ -525,7 +601,8 @@ void game_list_frame::Refresh(const bool from_drive, const bool scroll_after)
 
 		for (auto&& pair : get_games())
 		{
-			std::string game_dir = pair.second.Scalar();
+			// Disc images are mounted here, their index is kept for the whole session
+			std::string game_dir = resolve_iso_path(pair.second.Scalar());
 
 			game_dir.resize(game_dir.find_last_not_of('/') + 1);
 
@@ -569,7 +646,7 @@ void game_list_frame::Refresh(const bool from_drive, const bool scroll_after)
 			const Localized thread_localized;
 
 			const std::string sfo_dir = rpcs3::utils::get_sfo_dir_from_game_path(dir);
-			const psf::registry psf = psf::load_object(fs::file(sfo_dir + "/PARAM.SFO"));
+			const psf::registry psf = m_cache->get_psf(sfo_dir + "/PARAM.SFO");
 			const std::string_view title_id = psf::get_string(psf, "TITLE_ID", "");
 
 			if (title_id.empty())
@@ -765,6 +842,9 @@ void game_list_frame::OnRefreshFinished()
 	m_serials.clear();
 	m_path_list.clear();
 
+	// Forget removed games and store newly parsed ones
+	m_cache->save();
+
 	Refresh();
 }
 
@@ -781,6 +861,9 @@ void game_list_frame::OnRepaintFinished()
 
 		// Shorten the last section to remove horizontal scrollbar if possible
 		m_game_list->resizeColumnToContents(gui::column_count - 1);
+
+		// Catch up with rows that were scrolled into view in the meantime
+		LoadVisibleIcons();
 	}
 	else
 	{
@@ -1598,7 +1681,8 @@ bool game_list_frame::RemovePPUCache(const std::string& base_dir, bool is_intera
 	u32 files_removed = 0;
 	u32 files_total = 0;
 
-	const QStringList filter{ QStringLiteral("v*.obj"), QStringLiteral("v*.obj.gz") };
+	// Removing the manifests releases the objects in the shared store
+	const QStringList filter{ QStringLiteral("v*.obj"), QStringLiteral("v*.obj.gz"), QStringLiteral("objects.lst") };
 
 	QDirIterator dir_iter(qstr(base_dir), filter, QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
 
@@ -2166,6 +2250,7 @@ void game_list_frame::RepaintIcons(const bool& from_settings)
 		for (auto& game : m_game_data)
 		{
 			game->pxmap = placeholder;
+			game->icon_requested = false;
 			if (movie_item* item = game->item)
 			{
 				item->call_icon_func();
@@ -2181,19 +2266,89 @@ void game_list_frame::RepaintIcons(const bool& from_settings)
 
 		// Shorten the last section to remove horizontal scrollbar if possible
 		m_game_list->resizeColumnToContents(gui::column_count - 1);
+
+		// Only decode the icons of rows that can actually be seen. The rest follows when scrolling.
+		LoadVisibleIcons();
+		return;
 	}
 
 	const std::function func = [this](const game_info& game) -> movie_item*
 	{
-		if (game->icon.isNull() && (game->info.icon_path.empty() || !game->icon.load(qstr(game->info.icon_path))))
+		return PaintIcon(game);
+	};
+	m_repaint_watcher.setFuture(QtConcurrent::mapped(m_game_data, func));
+}
+
+movie_item* game_list_frame::PaintIcon(const game_info& game) const
+{
+	if (game->icon.isNull() && (game->icon = m_cache->get_icon(game->info.icon_path)).isNull())
+	{
+		game_list_log.warning("Could not load image from path %s", sstr(QDir(qstr(game->info.icon_path)).absolutePath()));
+	}
+	const QColor color = getGridCompatibilityColor(game->compat.color);
+	game->pxmap = PaintedPixmap(game->icon, game->hasCustomConfig, game->hasCustomPadConfig, color);
+	return game->item;
+}
+
+void game_list_frame::LoadVisibleIcons()
+{
+	if (!m_is_list_layout || m_repaint_watcher.isRunning())
+	{
+		// OnRepaintFinished will call us again
+		return;
+	}
+
+	// Prefetch one page above and below the viewport to make scrolling smooth
+	const int page = m_game_list->viewport()->height();
+	const int row_count = m_game_list->rowCount();
+	const int first_row = m_game_list->rowAt(-page);
+	const int last_row = m_game_list->rowAt(page * 2);
+
+	QList<game_info> games;
+
+	// Only visit the rows in range (rowAt returns -1 above the first or below the last row)
+	for (int row = std::max(first_row, 0); row < (last_row < 0 ? row_count : last_row + 1); row++)
+	{
+		if (m_game_list->isRowHidden(row))
+		{
+			continue;
+		}
+
+		const QTableWidgetItem* item = m_game_list->item(row, gui::column_icon);
+
+		if (!item)
+		{
+			continue;
+		}
+
+		const QVariant var = item->data(gui::game_role);
+
+		if (!var.canConvert<game_info>())
 		{
-			game_list_log.warning("Could not load image from path %s", sstr(QDir(qstr(game->info.icon_path)).absolutePath()));
+			continue;
 		}
-		const QColor color = getGridCompatibilityColor(game->compat.color);
-		game->pxmap = PaintedPixmap(game->icon, game->hasCustomConfig, game->hasCustomPadConfig, color);
-		return game->item;
+
+		const game_info game = var.value<game_info>();
+
+		if (!game || game->icon_requested)
+		{
+			continue;
+		}
+
+		game->icon_requested = true;
+		games.push_back(game);
+	}
+
+	if (games.isEmpty())
+	{
+		return;
+	}
+
+	const std::function func = [this](const game_info& game) -> movie_item*
+	{
+		return PaintIcon(game);
 	};
-	m_repaint_watcher.setFuture(QtConcurrent::mapped(m_game_data, func));
+	m_repaint_watcher.setFuture(QtConcurrent::mapped(games, func));
 }
 
 void game_list_frame::SetShowHidden(bool show)
@@ -2231,6 +2386,10 @@ void game_list_frame::resizeEvent(QResizeEvent *event)
 	{
 		Refresh(false, m_game_grid->selectedItems().count());
 	}
+	else
+	{
+		LoadVisibleIcons();
+	}
 	QDockWidget::resizeEvent(event);
 }
 
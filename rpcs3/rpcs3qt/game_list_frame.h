@@ -10,12 +10,16 @@
 #include <QToolBar>
 #include <QStackedWidget>
 #include <QSet>
+#include <QHash>
 #include <QTableWidgetItem>
 #include <QFutureWatcher>
+#include <QFileSystemWatcher>
+#include <QTimer>
 
 #include <memory>
 
 class game_list_grid;
+class game_list_cache;
 class gui_settings;
 class emu_settings;
 class persistent_settings;
@@ -95,6 +99,7 @@ protected:
 	bool eventFilter(QObject *object, QEvent *event) override;
 private:
 	QPixmap PaintedPixmap(const QPixmap& icon, bool paint_config_icon = false, bool paint_pad_config_icon = false, const QColor& color = QColor()) const;
+	movie_item* PaintIcon(const game_info& game) const;
 	QColor getGridCompatibilityColor(const QString& string) const;
 
 	/** Sets the custom config icon. Only call this for list title items. */
@@ -104,6 +109,9 @@ private:
 	void PopulateGameGrid(int maxCols, const QSize& image_size, const QColor& image_color);
 	bool IsEntryVisible(const game_info& game);
 	void SortGameList() const;
+
+	/** Paints the icons of list rows that are in or near the viewport and were not painted yet */
+	void LoadVisibleIcons();
 	bool SearchMatchesApp(const QString& name, const QString& serial) const;
 
 	bool RemoveCustomConfiguration(const std::string& title_id, const game_info& game = nullptr, bool is_interactive = false);
@@ -157,6 +165,10 @@ private:
 	lf_queue<game_info> m_games;
 	QFutureWatcher<void> m_refresh_watcher;
 	QFutureWatcher<movie_item*> m_repaint_watcher;
+	std::unique_ptr<game_list_cache> m_cache;
+	QFileSystemWatcher* m_dir_watcher = nullptr;
+	QHash<QString, QSet<QString>> m_watched_dirs; // Game directories found in each watched directory during the last refresh
+	QTimer* m_dir_refresh_timer = nullptr;
 	QSet<QString> m_hidden_list;
 	bool m_show_hidden{false};
 
@@ -51,6 +51,7 @@
 #include "Crypto/unself.h"
 #include "Crypto/decrypt_binaries.h"
 
+#include "Loader/ISO.h"
 #include "Loader/PUP.h"
 #include "Loader/TAR.h"
 #include "Loader/PSF.h"
@@ -433,7 +434,8 @@ void main_window::Boot(const std::string& path, const std::string& title_id, boo
 		gui_log.success("Boot successful.");
 		if (!add_only)
 		{
-			AddRecentAction(gui::Recent_Game(qstr(Emu.GetBoot()), qstr(Emu.GetTitleAndTitleID())));
+			// Disc images are booted from a virtual mount point which doesn't persist between sessions
+			AddRecentAction(gui::Recent_Game(qstr(iso_image_path(Emu.GetBoot())), qstr(Emu.GetTitleAndTitleID())));
 		}
 	}
 
@@ -457,6 +459,7 @@ void main_window::BootElf()
 		"SELF files (EBOOT.BIN *.self);;"
 		"BOOT files (*BOOT.BIN);;"
 		"BIN files (*.bin);;"
+		"Disc images (*.iso *.ISO);;"
 		"All files (*.*)"),
 		Q_NULLPTR, QFileDialog::DontResolveSymlinks);
 
@@ -1271,41 +1274,25 @@ void main_window::HandlePupInstallation(const QString& file_path, const QString&
 		// Run asynchronously
 		named_thread worker("Firmware Installer", [&]
 		{
-			for (const auto& update_filename : update_filenames)
+			switch (pup_install_packages(update_files, update_filenames, progress))
 			{
-				fs::file update_file = update_files.get_file(update_filename);
-
-				SCEDecrypter self_dec(update_file);
-				self_dec.LoadHeaders();
-				self_dec.LoadMetadata(SCEPKG_ERK, SCEPKG_RIV);
-				self_dec.DecryptData();
-
-				auto dev_flash_tar_f = self_dec.MakeFile();
-				if (dev_flash_tar_f.size() < 3)
-				{
-					gui_log.error("Error while installing firmware: PUP contents are invalid.");
-					critical(tr("Firmware installation failed: Firmware could not be decompressed"));
-					progress = -1;
-					return;
-				}
-
-				tar_object dev_flash_tar(dev_flash_tar_f[2]);
-				if (!dev_flash_tar.extract())
-				{
-					gui_log.error("Error while installing firmware: TAR contents are invalid. (package=%s)", update_filename);
-					critical(tr("The firmware contents could not be extracted."
-						"\nThis is very likely caused by external interference from a faulty anti-virus software."
-						"\nPlease add RPCS3 to your anti-virus\' whitelist or use better anti-virus software."));
-
-					progress = -1;
-					return;
-				}
-
-				if (!progress.try_inc(::narrow<uint>(update_filenames.size())))
-				{
-					// Installation was cancelled
-					return;
-				}
+			case pup_install_error::decrypt:
+			{
+				gui_log.error("Error while installing firmware: PUP contents are invalid.");
+				critical(tr("Firmware installation failed: Firmware could not be decompressed"));
+				break;
+			}
+			case pup_install_error::extract:
+			{
+				gui_log.error("Error while installing firmware: TAR contents are invalid.");
+				critical(tr("The firmware contents could not be extracted."
+					"\nThis is very likely caused by external interference from a faulty anti-virus software."
+					"\nPlease add RPCS3 to your anti-virus\' whitelist or use better anti-virus software."));
+				break;
+			}
+			case pup_install_error::ok:
+			case pup_install_error::cancelled:
+				break;
 			}
 		});
 
@@ -203,7 +203,7 @@ public:
 
 		// input
 
-		const QString pad_mode          = tr("Single-threaded: All pad handlers run on the same thread sequentially.\nMulti-threaded: Each pad handler has its own thread.\nOnly use multi-threaded if you can spare the extra threads.");
+		const QString pad_mode          = tr("Single-threaded: All pad handlers run on the same thread sequentially.\nMulti-threaded: Each pad handler has its own thread.\nEvent-driven: Like multi-threaded, but handlers wake up as soon as a device reports input instead of sleeping a fixed interval. Only supported by evdev, other handlers fall back to multi-threaded polling.\nOnly use multi-threaded or event-driven if you can spare the extra threads.");
 		const QString keyboard_handler  = tr("Some games support native keyboard input.\nBasic will work in these cases.");
 		const QString mouse_handler     = tr("Some games support native mouse input.\nBasic will work in these cases.");
 		const QString music_handler     = tr("Currently only used for cellMusic emulation.\nSelect Qt to use the default output device of your operating system.\nThis may not be able to play all audio formats.");
@@ -247,6 +247,17 @@ bool utils::has_fsrm()
 #endif
 }
 
+bool utils::has_sha()
+{
+#if defined(ARCH_X64)
+	// SHA extensions also need SSSE3 and SSE4.1 for the byte shuffles and blends
+	static const bool g_value = get_cpuid(0, 0)[0] >= 0x7 && (get_cpuid(7, 0)[1] & 0x20000000) == 0x20000000 && has_ssse3() && has_sse41();
+	return g_value;
+#else
+	return false;
+#endif
+}
+
 u32 utils::get_rep_movsb_threshold()
 {
 	static const u32 g_value = []()
@@ -41,6 +41,8 @@ namespace utils
 
 	bool has_fsrm();
 
+	bool has_sha();
+
 	std::string get_cpu_brand();
 
 	std::string get_system_info();
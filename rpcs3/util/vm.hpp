@@ -57,6 +57,9 @@ namespace utils
 	// Lock pages in memory
 	bool memory_lock(void* pointer, usz size);
 
+	// Request transparent huge pages for the 2 MiB aligned part of the range (returns false if unsupported)
+	bool memory_advise_huge(void* pointer, usz size);
+
 	// Map file descriptor
 	void* memory_map_fd(native_handle fd, usz size, protection prot);
 
@@ -438,6 +438,27 @@ namespace utils
 #endif
 	}
 
+	bool memory_advise_huge(void* pointer, usz size)
+	{
+#ifdef _WIN32
+		// Large pages require SeLockMemoryPrivilege and can't be used with placeholder mappings
+		static_cast<void>(pointer);
+		static_cast<void>(size);
+		return false;
+#else
+		const u64 ptr64 = reinterpret_cast<u64>(pointer);
+		const u64 start = utils::align(ptr64, 0x200000);
+		const u64 end = (ptr64 + size) & -0x200000;
+
+		if (c_madv_hugepage == 0 || start >= end)
+		{
+			return false;
+		}
+
+		return ::madvise(reinterpret_cast<void*>(start), end - start, c_madv_hugepage) != -1;
+#endif
+	}
+
 	void* memory_map_fd(native_handle fd, usz size, protection prot)
 	{
 #ifdef _WIN32